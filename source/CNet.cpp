@@ -41,8 +41,9 @@ class CNetwork: public DirectedCNetwork<T,B>
         double mean_clustering_coef() const;
 
 
-        void degree_distribution(vector<int> &distribution, bool normalized = false) const;
-        void degree_correlation(vector<int> &distribution, vector<double> &correlation, bool normalized = false) const;
+        void degree_distribution(vector<int> &distribution) const;
+        void degree_distribution(vector<double> &distribution) const;
+        void degree_correlation(vector<int> &distribution, vector<double> &correlation) const;
 
 
         int in_degree(int node_index) const;
@@ -119,6 +120,7 @@ void CNetwork<T,B>::clear_network()
 
     this->value = vector<T>();
 
+    if (this->tracking) this->tracker_rebuild();
 
     return;
 }
@@ -149,6 +151,8 @@ void CNetwork<T,B>::add_nodes(int n)
     {
         this->neighs.push_back(vector<unsigned int>()); //Add a new container for neighbours
     }
+
+    if (this->tracking) this->tracker_nodes_added(old_size);
     return;
 }
 
@@ -172,7 +176,7 @@ bool CNetwork<T,B>::remove_node(int index)
 
         //Re-scale all the neighbours index to fit the net, and also erase
         //the entry of the removed node as neighbour of others
-        for (i=0; i < this->neighs.size(); i++)
+        for (i=0; i < (int)this->neighs.size(); i++)
         {
             for (j=0; j < degree(i); j++)
             {
@@ -193,25 +197,25 @@ bool CNetwork<T,B>::remove_node(int index)
         for (i=0; i < this->link_count; i++)
         {
             //Separe cases from-to in order to correctly reduce degree
-            if (this->adjm[i].x == index || this->adjm[i].y == index)
+            if ((int)this->adjm[i].x == index || (int)this->adjm[i].y == index)
             {
                 //Our node is detected, erase the entry to that node
                 who_to_erase.push_back(i);
             }
 
             //Also reduce index of nodes higher than our
-            if (this->adjm[i].x > index)
+            if ((int)this->adjm[i].x > index)
             {
                 this->adjm[i].x -= 1;
             }
-            if (this->adjm[i].y > index)
+            if ((int)this->adjm[i].y > index)
             {
                 this->adjm[i].y -= 1;
             }
         }
 
         //Perform the erase process
-        for (i=0; i < who_to_erase.size(); i++)
+        for (i=0; i < (int)who_to_erase.size(); i++)
         {
             this->adjm.erase(who_to_erase[i]); //Delete all links
             //Index was recorded before, we do 2*who in order to get as even-odd again
@@ -220,6 +224,8 @@ bool CNetwork<T,B>::remove_node(int index)
         this->link_count -= who_to_erase.size() / 2; //Reduce the number of links
         this->current_size -= 1; //Reduce the current size of the network in one unit
 
+        this->comp_dirty = true; //Indices changed, so connectivity must be recomputed
+
         return true;
 
     }
@@ -242,6 +248,8 @@ void CNetwork<T,B>::add_link(int from, int to)
     this->neighs[to].push_back(from); //And do it in the other sense also
 
     this->link_count += 1; //Create one link more
+
+    if (this->tracking) this->tracker_link_added(from, to);
     return;
 }
 
@@ -263,6 +271,7 @@ void CNetwork<T,B>::add_link(int from, int to, B w)
 
     this->link_count += 1; //Create one link more
 
+    if (this->tracking) this->tracker_link_added(from, to);
     return;
 }
 
@@ -282,7 +291,7 @@ bool CNetwork<T,B>::remove_link(int from, int to)
     int index_neigh = distance(this->neighs[from].begin(), index_it); //Get the relative index as an int
 
 
-    if (index_neigh >= 0 and index_neigh < this->neighs[from].size())
+    if (index_neigh >= 0 and index_neigh < (int)this->neighs[from].size())
     {
         //int index_neigh = distance(neighs[from].begin(), index_it); //Get the relative index as an int
         int index_link = get_link_index(from, to);
@@ -302,6 +311,7 @@ bool CNetwork<T,B>::remove_link(int from, int to)
 
         this->neighs[to].erase(this->neighs[to].begin()+index_neigh);
 
+        if (this->tracking) this->tracker_link_removed(from, to);
         return true;
     }
     else return false;
@@ -345,6 +355,7 @@ void CNetwork<T,B>::remove_link(int index_link)
 
     this->neighs[to].erase(this->neighs[to].begin()+index_neigh);
 
+    if (this->tracking) this->tracker_link_removed(from, to);
     return;
 
 }
@@ -370,7 +381,8 @@ double CNetwork<T,B>::mean_degree() const
 *  \param index: target node
 *  \return clustering coefficient of target node
 *
-* Compute a clustering coefficient of a target node.
+* Compute a clustering coefficient of a target node. The list of neighbours is sorted once, and then the neighbours
+* of each neighbour are looked up on it. To compute the clustering of all the nodes, count_triangles is much faster.
 */
 template <class T, typename B>
 double CNetwork<T,B>::clustering_coef(int node_index) const
@@ -379,26 +391,24 @@ double CNetwork<T,B>::clustering_coef(int node_index) const
     {
         int i,j;
         int counter; //Count of pairs
+        unsigned int neigh;
 
-
-        vector<unsigned int> nodes_neigh = get_neighs(node_index);
-        vector<unsigned int> nodes_check;
+        vector<unsigned int> nodes_neigh = this->neighs[node_index]; //Only copy needed, to sort it
+        sort(nodes_neigh.begin(), nodes_neigh.end());
 
         counter = 0;
-        for (i=0; i < nodes_neigh.size(); i++) //Get neighbours of our node
+        for (i=0; i < (int)nodes_neigh.size(); i++) //Get neighbours of our node
         {
-            nodes_check = this->get_neighs(nodes_neigh[i]); //Get neighbours of node i
+            neigh = nodes_neigh[i];
 
-            //For the next nodes, (start in j=i+1 to avoid double-count a pair)
-            for (j=i+1; j < nodes_neigh.size(); j++)
+            //Check which of the neighbours of neigh are also our neighbours. Each pair will be seen twice.
+            for (j=0; j < (int)this->neighs[neigh].size(); j++)
             {
-                //Use the  find function to see if this node is connected to any other neighbours of our node.
-                //In that case, increase the counter
-                if (find(nodes_check.begin(), nodes_check.end(), nodes_neigh[j]) != nodes_check.end()) counter += 1;
+                if (binary_search(nodes_neigh.begin(), nodes_neigh.end(), this->neighs[neigh][j])) counter += 1;
             }
         }
 
-        return 2.0 * counter / (degree(node_index) * (degree(node_index) - 1)); //Finish computation and return clustering coefficient
+        return 1.0 * counter / (degree(node_index) * (degree(node_index) - 1)); //Finish computation and return clustering coefficient
     }
     else //... in other case, we cannot have common neighbours
     {
@@ -411,18 +421,22 @@ double CNetwork<T,B>::clustering_coef(int node_index) const
 *  \return clustering coefficient of the network
 *
 * Computes the clustering coefficient of each element, and takes the average.
-* It is not the same as the one computed counting triangles.
+* It is not the same as the one computed counting triangles, which is given as transitivity by count_triangles.
 */
 template <class T, typename B>
 double CNetwork<T,B>::mean_clustering_coef() const
 {
     int i;
     double sum = 0.0; //Get the sum,
+    double transitivity;
+    vector<double> clustering;
+
+    this->count_triangles(clustering, transitivity); //Get all the coefficients at once
 
     //Sum over the network
     for (i=0; i < this->current_size; i++)
     {
-        sum += clustering_coef(i);
+        sum += clustering[i];
     }
     //Divide by current size
     return sum / (this->current_size * 1.0);
@@ -430,14 +444,24 @@ double CNetwork<T,B>::mean_clustering_coef() const
 
 /** \brief Computes the degree distribution of the network
 *  \param[out] distribution: index j contains number of nodes with degree j. It is the degree distribution
-*  \param normalized: optional. If set to true, returns a normalized distribution. False by default.
 *
 * Compute the degree distribution of the network. If you also need the correlations, please use instead degree_correlation.
+* For the normalized distribution, pass a vector of doubles.
 */
 template <class T, typename B>
-void CNetwork<T,B>::degree_distribution(vector<int> &distribution, bool normalized) const
+void CNetwork<T,B>::degree_distribution(vector<int> &distribution) const
 {
-    DirectedCNetwork<T,B>::degree_distribution(distribution, this->TOTAL_DEGREE, normalized);
+    DirectedCNetwork<T,B>::degree_distribution(distribution, this->TOTAL_DEGREE);
+    return;
+}
+
+/** \brief Computes the normalized degree distribution of the network
+*  \param[out] distribution: index j contains the fraction of nodes with degree j
+*/
+template <class T, typename B>
+void CNetwork<T,B>::degree_distribution(vector<double> &distribution) const
+{
+    DirectedCNetwork<T,B>::degree_distribution(distribution, this->TOTAL_DEGREE);
     return;
 }
 
@@ -445,15 +469,14 @@ void CNetwork<T,B>::degree_distribution(vector<int> &distribution, bool normaliz
 /** \brief Computes the degree distribution and correlations
 *  \param[out] distribution: index j contains number of nodes with degree j. It is the degree distribution
 *  \param[out] correlation: index j contains average degree of neighbours of a node with degree j
-*  \param normalized: optional. If set to true, returns a normalized distribution. False by default.
 *
 * Computes the average number of neighbours that a node with degree j has. It also computes and stores the degree distribution,
 * since both quantities are usually needed.
 */
 template <class T, typename B>
-void CNetwork<T,B>::degree_correlation(vector<int> &distribution, vector<double> &correlation, bool normalized) const
+void CNetwork<T,B>::degree_correlation(vector<int> &distribution, vector<double> &correlation) const
 {
-    DirectedCNetwork<T,B>::degree_correlation(distribution, this->TOTAL_DEGREE, normalized);
+    DirectedCNetwork<T,B>::degree_correlation(distribution, correlation, this->TOTAL_DEGREE);
     return;
 }
 
@@ -573,13 +596,13 @@ int CNetwork<T,B>::get_in(int node_index, int k) const
 template <class T, typename B>
 int CNetwork<T,B>::get_link_index(int from, int to) const
 {
-    int i,even,odd;
+    int i;
     bool found = false;
     i = 0;
 
     while (i < this->link_count and not found)
     {
-        found = (this->adjm[i].x == from and this->adjm[i].y == to) or (this->adjm[i].x == to and this->adjm[i].y == from);
+        found = ((int)this->adjm[i].x == from and (int)this->adjm[i].y == to) or ((int)this->adjm[i].x == to and (int)this->adjm[i].y == from);
         i += 1;
     }
 
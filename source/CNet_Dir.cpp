@@ -8,6 +8,13 @@
 #include<sstream>
 #include<functional>
 #include<map>
+#include<queue>
+#include<cstring>
+#include<limits>
+
+#ifdef _OPENMP
+#include<omp.h>
+#endif
 
 #include "SparseMatrix.cpp"
 
@@ -21,21 +28,587 @@ This software is Open Source and redistributed with a MIT LICENSE (Read LICENSE
 Please follow license terms when using this code.
 
 ========================================================================================================== */
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Counter-based random number stream
+*
+* Small generator based on the splitmix64 mixing function. Every pair (seed, stream) gives a different, independent
+* sequence, so parallel loops can give a stream to each block of work and still get the same results for any number
+* of threads. It satisfies the requirements of a random engine, so it can be used with the standard distributions.
+*/
+struct rng_stream
+{
+    typedef unsigned long long result_type;
+    unsigned long long state;
+
+    rng_stream(unsigned long long seed, unsigned long long stream = 0) {state = mix(seed ^ mix(stream + 0x632BE59BD9B4E019ULL));};
+
+    static unsigned long long mix(unsigned long long z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+
+    static constexpr result_type min() {return 0ULL;};
+    static constexpr result_type max() {return ~0ULL;};
+
+    result_type operator()() {state += 0x9E3779B97F4A7C15ULL; return mix(state);};
+
+    double uniform() {return ((*this)() >> 11) * (1.0 / 9007199254740992.0);}; ///Uniform double in [0,1)
+    unsigned long long below(unsigned long long n) {return (*this)() % n;}; ///Uniform integer in [0,n)
+};
+
 
 // ========================================================================================================
 // ========================================================================================================
 // ========================================================================================================
 
 
+/** \brief Monotone priority queue for non-negative distances
+*
+* Radix heap. The bits of a non-negative double, read as an integer, keep the order of the numbers, so distances are
+* stored in 65 buckets given by the highest bit that differs from the last extracted key. Each entry is moved at most
+* 64 times. Keys pushed must not be smaller than the last one extracted, which holds in Dijkstra's algorithm.
+*/
+struct radix_heap
+{
+    vector< pair<unsigned long long, int> > bucket[65];
+    unsigned long long last;
+    int n;
+
+    radix_heap() {clear();};
+
+    static unsigned long long key(double d) {unsigned long long k; memcpy(&k, &d, sizeof(k)); return k;};
+    static int index(unsigned long long a, unsigned long long b) {return a == b ? 0 : 64 - __builtin_clzll(a ^ b);};
+
+    bool empty() const {return n == 0;};
+
+    void clear()
+    {
+        for (int i=0; i < 65; i++) bucket[i].clear();
+        last = 0;
+        n = 0;
+    };
+
+    void push(double d, int v)
+    {
+        unsigned long long k = key(d);
+        bucket[index(k, last)].push_back(make_pair(k, v));
+        n += 1;
+    };
+
+    pair<double,int> pop() ///Extracts the element with smallest key
+    {
+        int i, j;
+        double d;
+
+        if (bucket[0].empty())
+        {
+            //Redistribute the first non-empty bucket around its minimum
+            i = 1;
+            while (bucket[i].empty()) i++;
+            last = bucket[i][0].first;
+            for (j=1; j < (int)bucket[i].size(); j++) last = min(last, bucket[i][j].first);
+            for (j=0; j < (int)bucket[i].size(); j++) bucket[index(bucket[i][j].first, last)].push_back(bucket[i][j]);
+            bucket[i].clear();
+        }
+
+        pair<unsigned long long, int> top = bucket[0].back();
+        bucket[0].pop_back();
+        n -= 1;
+        memcpy(&d, &top.first, sizeof(d));
+        return make_pair(d, top.second);
+    };
+};
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Hash multiset of links
+*
+* Open addressing with linear probing over a power of two table, with backward shift deletion so there are no
+* tombstones and probes stay short after many insertions and deletions. Each entry keeps how many times the link is
+* present. Links are given as 64 bit keys, see DirectedCNetwork::edge_swaps. The table does not grow, so the capacity
+* must be larger than the number of different links.
+*/
+struct link_set
+{
+    vector<unsigned long long> keys;
+    vector<int> counts;
+    unsigned long long mask;
+
+    static const unsigned long long EMPTY = ~0ULL;
+
+    link_set(long long capacity = 0)
+    {
+        unsigned long long size = 16;
+        while ((long long)size < 2 * capacity) size *= 2;
+        keys = vector<unsigned long long>(size, ~0ULL);
+        counts = vector<int>(size, 0);
+        mask = size - 1;
+    };
+
+    unsigned long long slot(unsigned long long k) const {return rng_stream::mix(k) & mask;};
+
+    long long find(unsigned long long k) const ///Position of the key, or -1
+    {
+        unsigned long long i = slot(k);
+        while (keys[i] != EMPTY)
+        {
+            if (keys[i] == k) return i;
+            i = (i + 1) & mask;
+        }
+        return -1;
+    };
+
+    bool contains(unsigned long long k) const {return find(k) >= 0;};
+
+    void insert(unsigned long long k)
+    {
+        unsigned long long i = slot(k);
+        while (keys[i] != EMPTY and keys[i] != k) i = (i + 1) & mask;
+        keys[i] = k;
+        counts[i] += 1;
+    };
+
+    void erase(unsigned long long k) ///Removes one copy of the key, if present
+    {
+        long long pos = find(k);
+        if (pos < 0) return;
+        counts[pos] -= 1;
+        if (counts[pos] > 0) return;
+
+        //Move back the entries that would not be found after leaving a hole
+        unsigned long long i = pos, j = pos, h;
+        while (true)
+        {
+            j = (j + 1) & mask;
+            if (keys[j] == EMPTY) break;
+            h = slot(keys[j]);
+            if ((j > i and (h <= i or h > j)) or (j < i and h <= i and h > j))
+            {
+                keys[i] = keys[j];
+                counts[i] = counts[j];
+                i = j;
+            }
+        }
+        keys[i] = EMPTY;
+        counts[i] = 0;
+    };
+};
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Random permutation of a vector, in parallel
+*  \param v: vector to shuffle
+*  \param seed: random seed. The result only depends on the seed, not on the number of threads.
+*
+* Each element is sent to one of 256 buckets chosen at random, the buckets are joined in order and then each one is
+* shuffled with Fisher-Yates. This gives a uniform permutation, with a fixed split of the work in random streams.
+* Needs a copy of the vector.
+*/
+template <class X>
+void parallel_shuffle(vector<X> &v, unsigned long long seed)
+{
+    const int n_buckets = 256;
+    long long i, j, n;
+    int b, c;
+
+    n = v.size();
+    vector<unsigned char> bucket(n);
+    vector<long long> offset(n_buckets * n_buckets + 1, 0); //Position of chunk c in bucket b is at b*n_buckets + c
+    vector<X> shuffled(n);
+
+    //Choose the bucket of each element, counting them by chunk
+    #pragma omp parallel for schedule(static) private(i)
+    for (c=0; c < n_buckets; c++)
+    {
+        rng_stream gen(seed, c);
+        for (i = n * c / n_buckets; i < n * (c+1) / n_buckets; i++)
+        {
+            bucket[i] = gen.below(n_buckets);
+            offset[bucket[i] * n_buckets + c + 1] += 1;
+        }
+    }
+    for (i=0; i < n_buckets * n_buckets; i++) offset[i+1] += offset[i];
+
+    #pragma omp parallel for schedule(static) private(i, j, b)
+    for (c=0; c < n_buckets; c++)
+    {
+        vector<long long> position(n_buckets);
+        for (b=0; b < n_buckets; b++) position[b] = offset[b * n_buckets + c];
+        for (i = n * c / n_buckets; i < n * (c+1) / n_buckets; i++)
+        {
+            j = position[bucket[i]]++;
+            shuffled[j] = v[i];
+        }
+    }
+
+    //Fisher-Yates inside each bucket
+    #pragma omp parallel for schedule(dynamic, 1) private(i, j)
+    for (b=0; b < n_buckets; b++)
+    {
+        rng_stream gen(seed, n_buckets + b);
+        long long start = offset[b * n_buckets];
+        long long end = offset[(b+1) * n_buckets];
+        for (i = end - 1; i > start; i--)
+        {
+            j = start + gen.below(i - start + 1);
+            swap(shuffled[i], shuffled[j]);
+        }
+    }
+
+    v.swap(shuffled);
+    return;
+}
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Copies the columns of a property map for a subgraph
+*  \param source: properties of the original network
+*  \param[out] target: properties of the subgraph
+*  \param n_nodes, n_links: number of nodes and links of the original network
+*  \param nodes, links: original index of each node and link kept, in their new order
+*
+* Columns with one element per node are treated as node properties, and the rest as link properties, as in write_graphml.
+*/
+template <class X>
+void copy_property_columns(const map<string, vector<X> > &source, map<string, vector<X> > &target, int n_nodes, int n_links,
+                           const vector<int> &nodes, const vector<int> &links)
+{
+    int i;
+
+    target.clear();
+    for (auto &property : source)
+    {
+        const vector<int> &kept = (int)property.second.size() == n_nodes ? nodes : links;
+        if ((int)property.second.size() != n_nodes and (int)property.second.size() != n_links) continue;
+
+        vector<X> column(kept.size());
+        for (i=0; i < (int)kept.size(); i++) column[i] = property.second[kept[i]];
+        target[property.first] = column;
+    }
+    return;
+}
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Frozen adjacency for fast random walks
+*
+* Compact copy of the links going out of each node, sorted by target, built with DirectedCNetwork::build_walk_adjacency.
+* For weighted walks it also holds an alias table for each node, so a weighted neighbour is chosen in O(1) with one
+* random slot and one coin. Walkers are advanced in lock-step in small batches, so the memory accesses of
+* independent walkers overlap, and each walker has its own counter-based stream: the walks are the same for any number
+* of threads. Changes in the network after building it are not seen.
+*/
+struct walk_adjacency
+{
+    vector<long long> offset; ///Links of node j are between offset[j] and offset[j+1]
+    vector<unsigned int> target; ///Node at the other end of each link, sorted for each node
+    vector<float> prob; ///Alias table: probability of keeping each slot
+    vector<unsigned int> alias; ///Alias table: slot used otherwise, relative to the offset of the node
+    bool weighted;
+
+    int step(int node, rng_stream &gen) const;
+    bool has_link(int from, int to) const;
+    void walks(const vector<int> &start, int length, vector<int> &paths, unsigned int random_seed = 123456789) const;
+    void node2vec_walks(const vector<int> &start, int length, double p, double q, vector<int> &paths, unsigned int random_seed = 123456789) const;
+};
+
+
+/** \brief Moves a walker one step
+*  \param node: current position
+*  \param gen: random stream of the walker
+*  \return next position, or -1 if the node has no links going out
+*/
+inline int walk_adjacency::step(int node, rng_stream &gen) const
+{
+    long long k = offset[node+1] - offset[node];
+    if (k == 0) return -1;
+
+    long long slot = gen.below(k);
+    if (weighted and gen.uniform() >= prob[offset[node] + slot]) slot = alias[offset[node] + slot];
+    return target[offset[node] + slot];
+}
+
+
+/** \brief Checks if there is a link between two nodes, with a binary search
+*/
+inline bool walk_adjacency::has_link(int from, int to) const
+{
+    return binary_search(target.begin() + offset[from], target.begin() + offset[from+1], (unsigned int)to);
+}
+
+
+/** \brief Simple random walks from a list of nodes
+*  \param start: initial node of each walker
+*  \param length: number of steps of each walk
+*  \param[out] paths: walk of walker j is stored between j*(length+1) and (j+1)*(length+1), starting with its initial
+*  node. If a walker gets to a node without outgoing links, the rest of its walk is filled with -1.
+*  \param random_seed: optional. Walker j uses the stream j of this seed.
+*
+* Weighted steps use the alias tables. Walkers are processed in parallel, in batches advanced together.
+*/
+inline void walk_adjacency::walks(const vector<int> &start, int length, vector<int> &paths, unsigned int random_seed) const
+{
+    const int batch = 64;
+    long long b;
+    long long n_walkers = start.size();
+
+    paths = vector<int>(n_walkers * (length+1), -1);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (b=0; b < n_walkers; b += batch)
+    {
+        int j, s;
+        int size = min((long long)batch, n_walkers - b);
+        int position[batch];
+        vector<rng_stream> gen;
+
+        for (j=0; j < size; j++)
+        {
+            gen.push_back(rng_stream(random_seed, b+j));
+            position[j] = start[b+j];
+            paths[(b+j) * (length+1)] = position[j];
+        }
+
+        for (s=1; s <= length; s++)
+        {
+            for (j=0; j < size; j++)
+            {
+                if (position[j] < 0) continue;
+                position[j] = step(position[j], gen[j]);
+                paths[(b+j) * (length+1) + s] = position[j];
+            }
+        }
+    }
+
+    return;
+}
+
+
+/** \brief Second order random walks of node2vec
+*  \param start: initial node of each walker
+*  \param length: number of steps of each walk
+*  \param p: return parameter. Going back to the previous node has weight 1/p.
+*  \param q: in-out parameter. Going to a node not linked to the previous one has weight 1/q.
+*  \param[out] paths: walks, stored as in walks()
+*  \param random_seed: optional. Walker j uses the stream j of this seed.
+*
+* Uses rejection sampling: a neighbour is proposed with the first order rule (uniform or by weight), and accepted with
+* probability given by its node2vec factor divided by the largest factor. No table of size sum of k^2 is needed.
+*/
+inline void walk_adjacency::node2vec_walks(const vector<int> &start, int length, double p, double q, vector<int> &paths, unsigned int random_seed) const
+{
+    const int batch = 64;
+    long long b;
+    long long n_walkers = start.size();
+    double max_factor = max(1.0, max(1.0/p, 1.0/q));
+
+    paths = vector<int>(n_walkers * (length+1), -1);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (b=0; b < n_walkers; b += batch)
+    {
+        int j, s;
+        int size = min((long long)batch, n_walkers - b);
+        int position[batch], previous[batch];
+        vector<rng_stream> gen;
+
+        for (j=0; j < size; j++)
+        {
+            gen.push_back(rng_stream(random_seed, b+j));
+            position[j] = start[b+j];
+            previous[j] = -1;
+            paths[(b+j) * (length+1)] = position[j];
+        }
+
+        for (s=1; s <= length; s++)
+        {
+            for (j=0; j < size; j++)
+            {
+                if (position[j] < 0) continue;
+
+                int next = step(position[j], gen[j]);
+                if (previous[j] >= 0 and next >= 0)
+                {
+                    //Propose until accepted
+                    while (true)
+                    {
+                        double factor;
+                        if (next == previous[j]) factor = 1.0 / p;
+                        else if (has_link(previous[j], next)) factor = 1.0;
+                        else factor = 1.0 / q;
+                        if (gen[j].uniform() * max_factor < factor) break;
+                        next = step(position[j], gen[j]);
+                    }
+                }
+
+                previous[j] = position[j];
+                position[j] = next;
+                paths[(b+j) * (length+1) + s] = next;
+            }
+        }
+    }
+
+    return;
+}
+
+
+/** \brief Linear preferential attachment without communication
+*
+* Generates the links of a preferential attachment network, used by DirectedCNetwork::create_preferential_attachment.
+* Nodes 0 to m0-1 form a clique, and every later node v links to m different older nodes. An older node u is chosen
+* with probability proportional to q_u + o_u + A, where q_u are the links u received, o_u the links it created (m, or
+* m0-1 for the clique) and A the attractiveness, so A = 0 is the Albert-Barabasi model. The received part is sampled
+* in O(1) picking a uniform position in the list of targets of the previous links, as in Batagelj and Brandes, and the
+* rest picking a node uniformly.
+* As in the method of Sanders and Schulz, node v draws from its own random stream, and all the links of older nodes
+* are known beforehand, so nodes can be processed in any order: when v needs the target of a link that is not there
+* yet, it is computed on the fly. Repeated targets are drawn again, so each node gets exactly m links, and the result
+* does not depend on the number of threads.
+*/
+struct attachment_process
+{
+    long long n, m0, m;
+    double attractiveness, clique_weight;
+    unsigned int seed;
+    vector<unsigned int> target; ///Target of the j-th link of node v is at (v-m0)*m + j
+    vector<char> done; ///Marks the nodes whose links are already in target
+
+    attachment_process(long long n_nodes, long long clique, long long links, double a, unsigned int random_seed);
+
+    unsigned int link_target(long long position);
+    void attach(long long v);
+};
+
+
+inline attachment_process::attachment_process(long long n_nodes, long long clique, long long links, double a, unsigned int random_seed)
+{
+    n = n_nodes;
+    m0 = clique;
+    m = links;
+    attractiveness = a;
+    clique_weight = max(0.0, m0 - 1.0 + a);
+    seed = random_seed;
+    target = vector<unsigned int>(max(0LL, (n - m0) * m));
+    done = vector<char>(max(0LL, n - m0), 0);
+}
+
+
+/** \brief Target of a link, computing it if needed
+*  \param position: index of the link in target
+*/
+inline unsigned int attachment_process::link_target(long long position)
+{
+    char ready;
+    long long v = m0 + position / m;
+    unsigned int t;
+
+    #pragma omp atomic read
+    ready = done[v - m0];
+
+    if (not ready) attach(v);
+    #pragma omp flush
+
+    #pragma omp atomic read
+    t = target[position];
+    return t;
+}
+
+
+/** \brief Chooses the m targets of node v
+*
+* If two threads attach the same node at the same time, both write the same values, since the draws only depend
+* on the stream of the node.
+*/
+inline void attachment_process::attach(long long v)
+{
+    int j, l;
+    long long chosen, received;
+    double x, total;
+    bool repeated;
+
+    rng_stream gen(seed, v);
+    vector<unsigned int> mine(m);
+
+    received = (v - m0) * m;
+    total = received + m0 * clique_weight + (v - m0) * (m + attractiveness);
+
+    j = 0;
+    while (j < m)
+    {
+        x = gen.uniform() * total;
+        if (total <= 0.0) chosen = gen.below(v); //Only when nothing has weight, in the first node
+        else if (x < received) chosen = link_target(min((long long)x, received - 1)); //Proportional to received links
+        else
+        {
+            x -= received;
+            if (x < m0 * clique_weight) chosen = min((long long)(x / clique_weight), m0 - 1);
+            else chosen = m0 + min((long long)((x - m0 * clique_weight) / (m + attractiveness)), v - m0 - 1);
+        }
+
+        repeated = false;
+        for (l=0; l < j and not repeated; l++) repeated = mine[l] == chosen;
+        if (not repeated)
+        {
+            mine[j] = chosen;
+            j++;
+        }
+    }
+
+    for (j=0; j < m; j++)
+    {
+        #pragma omp atomic write
+        target[received + j] = mine[j];
+    }
+    #pragma omp flush
+    #pragma omp atomic write
+    done[v - m0] = 1;
+
+    return;
+}
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
 /** \brief Directed DirectedCNetwork base class
 *
 *   Directed DirectedCNetwork is the core class for a weighted, directed network.
 *   Needs two template arguments: class associated to nodes and links
 *
 */
+template <class T, typename B>
+class NetworkView;
+
 template <class T = void, class B = bool>
 class DirectedCNetwork
 {
+    friend class NetworkView<T,B>;
+
     public:
 
 
@@ -46,29 +619,87 @@ class DirectedCNetwork
 
         void add_link(int from, int to);
         void add_link(int from, int to, B w);
+        void add_links(const vector< pair<unsigned int, unsigned int> > &links, const vector<B> &weights = vector<B>());
         bool remove_link(int from, int to);
         void remove_link(int index_link);
 
 
 
         double mean_degree(int type) const;
-        void degree_distribution(vector<int> &distribution, int type, bool normalized = false) const;
-        void degree_correlation(vector<int> &distribution, vector<double> &correlation,  int type, bool normalized = false) const;
+        void degree_distribution(vector<int> &distribution, int type) const;
+        void degree_distribution(vector<double> &distribution, int type) const;
+        void degree_correlation(vector<int> &distribution, vector<double> &correlation,  int type) const;
+        void degree_statistics(vector<int> &in_distribution, vector<int> &out_distribution, vector<int> &distribution,
+                               vector<double> &correlation, double &mean_k, double &mean_k2, double &assortativity, int type = TOTAL_DEGREE) const;
 
 
         void breadth_first_search(int node, vector<int> &dist) const;
         void component_nodes(int index, vector<int> &list_nodes, int comp_size = -1) const;
         void component_size(vector<int> &node_in_this_component, vector<int> &size_of_components) const;
         int largest_component_size() const;
+        void induced_subgraph(const vector<int> &nodes, DirectedCNetwork<T,B> &sub, vector<int> &new_index) const;
+        void ego_network(int node_index, int radius, DirectedCNetwork<T,B> &sub, vector<int> &new_index) const;
+        void track_components(bool enable = true);
+        bool same_component(int a, int b) const;
         double average_pathlenght() const;
         double average_pathlenght_component(int component_index, int comp_size = -1) const;
+        void betweenness(vector<double> &node_bc, vector<double> &link_bc, bool weighted = false, bool normalized = false) const;
+        int approx_betweenness(vector<double> &node_bc, vector<double> &link_bc, double epsilon, double delta = 0.1, bool weighted = false, bool normalized = false, unsigned int random_seed = 123456789) const;
+        void weighted_distances(int source, vector<double> &dist, double delta = 0.0) const;
+        void weighted_distances(const vector<int> &sources, vector< vector<double> > &dist) const;
+        double weighted_average_pathlength(double &diameter) const;
+        int diameter(int &radius, vector<int> &eccentricity, bool all_eccentricities = true) const;
+        void closeness(vector<double> &closeness_c, vector<double> &harmonic) const;
+        void build_walk_adjacency(walk_adjacency &walker, bool weighted = false) const;
+        void percolation(vector<double> &largest, vector<double> &susceptibility, vector<double> &second, bool site = true,
+                         const vector<int> &order = vector<int>(), unsigned int random_seed = 123456789) const;
+        void attack_order(vector<int> &order, const vector<double> &score = vector<double>(), bool adaptive = false) const;
+        int approx_closeness(vector<double> &closeness_c, vector<double> &harmonic, int log2_registers = 6, unsigned int random_seed = 123456789) const;
+
+
+
+        int strong_components(vector<int> &component, bool parallel = false) const;
+        int weak_components(vector<int> &component) const;
+        void condensation(const vector<int> &component, int n_components, vector< pair<int,int> > &dag_links) const;
+
+
+
+        long long count_triangles(vector<double> &clustering, double &transitivity) const;
+        int core_decomposition(vector<int> &coreness, vector<int> &ordering, bool parallel = false) const;
+        int coloring(vector<int> &color, vector<int> &class_start, vector<int> &class_nodes, int ordering = SMALLEST_LAST, unsigned int random_seed = 123456789) const;
+        void coloring_statistics(vector<int> &n_colors, vector<int> &rounds, vector< vector<int> > &class_sizes, vector<int> &hub_colors,
+                                 int n_hubs = 100, unsigned int random_seed = 123456789) const;
+        int independent_set(vector<int> &nodes, unsigned int random_seed = 123456789) const;
+
+
+
+        double modularity(const vector<int> &community, bool weighted = false, double resolution = 1.0) const;
+        double louvain(vector<int> &community, bool weighted = false, bool leiden_refinement = true, double resolution = 1.0, unsigned int random_seed = 123456789) const;
+        double approx_transitivity(double &error, int max_samples = 1000000, double target_error = 0.0, unsigned int random_seed = 123456789) const;
+        double approx_mean_clustering(double &error, int max_samples = 1000000, double target_error = 0.0, unsigned int random_seed = 123456789) const;
+        double approx_clustering_coef(int node_index, double &error, int max_samples = 10000, double target_error = 0.0, unsigned int random_seed = 123456789) const;
 
 
 
         void create_albert_barabasi(int n, int m0, int m, unsigned int random_seed = 123456789);
+        void create_preferential_attachment(int n, int m0, int m, double attractiveness = 0.0, unsigned int random_seed = 123456789);
         void create_configurational(int nodes, int kmin, double gamma, unsigned int random_seed);
+        void create_configuration_model(const vector<int> &degrees, int simple = ERASED, unsigned int random_seed = 123456789);
+        void create_configuration_model(const vector<int> &out_degrees, const vector<int> &in_degrees, int simple = ERASED, unsigned int random_seed = 123456789);
+        void create_sbm(const vector<int> &block_sizes, const vector< vector<double> > &probability, const vector<double> &propensity = vector<double>(),
+                        string property = "block", unsigned int random_seed = 123456789);
+        void create_lfr(int nodes, int min_degree, int max_degree, double degree_exponent, double size_exponent, double mixing,
+                        int min_size, int max_size, string property = "community", unsigned int random_seed = 123456789);
+        void create_random_geometric(int nodes, double radius, int dimension = 2, bool periodic = false, unsigned int random_seed = 123456789);
+        void create_soft_geometric(int nodes, double cutoff, function<double(double)> kernel, int dimension = 2, bool periodic = false,
+                                   unsigned int random_seed = 123456789);
         void create_watts_strogatz(int nodes, int regular_connections, double p, unsigned int random_seed);
         void create_erdos_renyi(int nodes, double mean_k, unsigned int random_seed=123456789);
+        void create_erdos_renyi_links(int nodes, long long n_links, unsigned int random_seed = 123456789);
+        void create_rmat(int scale, int edge_factor = 16, double a = 0.57, double b = 0.19, double c = 0.19, unsigned int random_seed = 123456789);
+        long long write_rmat(string filename, int scale, int edge_factor = 16, double a = 0.57, double b = 0.19, double c = 0.19, unsigned int random_seed = 123456789) const;
+        long long rewire(long long swaps, unsigned int random_seed = 123456789);
+        void rewired_samples(int n_samples, long long swaps, vector< vector< pair<unsigned int, unsigned int> > > &samples, unsigned int random_seed = 123456789) const;
 
 
 
@@ -80,8 +711,9 @@ class DirectedCNetwork
 
         vector<int> get_link(int link_index) const;
         B get_weight(int link_index) const;
-        void set_weight(int link_index, B weight) const;
+        void set_weight(int link_index, B weight);
         int get_link_index(int from, int to) const;
+        bool are_linked(int a, int b) const;
 
 
 
@@ -123,6 +755,11 @@ class DirectedCNetwork
 
 
         vector<double> compute_eigenv(double approx_error, int max_it = 20) const;
+        int pagerank(vector<double> &rank, double damping = 0.85, const vector<double> &personalization = vector<double>(), bool gauss_seidel = false, double tolerance = 1e-10, int max_it = 200) const;
+        int katz_centrality(vector<double> &centrality, double alpha, double beta = 1.0, double tolerance = 1e-10, int max_it = 200) const;
+        int eigenvector_centrality(vector<double> &centrality, double tolerance = 1e-10, int max_it = 500) const;
+        void personalized_pagerank(int seed, vector< pair<int,double> > &ppr, double alpha = 0.15, double epsilon = 1e-7, int walks = 0, unsigned int random_seed = 123456789) const;
+        void personalized_pagerank(const vector<int> &seeds, vector< vector< pair<int,double> > > &ppr, double alpha = 0.15, double epsilon = 1e-7, int walks = 0, unsigned int random_seed = 123456789) const;
 
         void clear_network();
 
@@ -130,6 +767,12 @@ class DirectedCNetwork
         static const int IN_DEGREE = 0; /// To set the type of degree in some methods
         static const int OUT_DEGREE = 1; /// To set the type of degree in some methods
         static const int TOTAL_DEGREE = 2; /// To set the type of degree in some methods
+        static const int RANDOM_ORDER = 0; /// Node orderings for coloring
+        static const int LARGEST_FIRST = 1; /// Node orderings for coloring
+        static const int SMALLEST_LAST = 2; /// Node orderings for coloring
+        static const int MULTIGRAPH = 0; /// Handling of self-loops and multi-links in the configuration model
+        static const int ERASED = 1; /// Handling of self-loops and multi-links in the configuration model
+        static const int SWITCHING = 2; /// Handling of self-loops and multi-links in the configuration model
 
         SparseMatrix<B> adjm;
 
@@ -151,6 +794,57 @@ class DirectedCNetwork
         map<string, vector<int> > prop_i;
         map<string, vector<bool> > prop_b;
         map<string, vector<string> > prop_s;
+
+        //Incremental connectivity, see track_components
+        bool tracking;
+        mutable bool comp_dirty;
+        mutable int largest_comp;
+        mutable int search_stamp;
+        mutable vector<int> comp_label, comp_size, size_count, free_labels, search_mark;
+
+
+        int strong_components_pearce(vector<int> &component) const;
+        int strong_components_coloring(vector<int> &component) const;
+
+        void build_undirected_csr(vector<long long> &offset, vector<unsigned int> &adj) const;
+        int neigh_degree(int node_index, int type) const;
+        void rebuild_neighbours();
+        void match_stubs(const vector<unsigned int> &out_stubs, vector<unsigned int> &in_stubs, int first, int simple, unsigned int random_seed);
+        long long repair_links(vector<unsigned int> &from, vector<unsigned int> &to, rng_stream &gen, const vector<int> &group = vector<int>()) const;
+        void pair_from_index(unsigned long long index, unsigned int &i, unsigned int &j) const;
+        void set_membership(string property, int first, const vector<int> &membership);
+        void spatial_links(int n, double cutoff, const function<double(double)> &kernel, int dimension, bool periodic, unsigned int random_seed);
+        void rmat_edges(long long begin, long long end, int scale, double a, double b, double c, unsigned int random_seed,
+                        unsigned int first, pair<unsigned int, unsigned int> *edges) const;
+        void tracker_rebuild() const;
+        void tracker_nodes_added(int old_size);
+        void tracker_link_added(int from, int to);
+        void tracker_link_removed(int from, int to);
+        long long edge_swaps(vector<unsigned int> &from, vector<unsigned int> &to, long long swaps, rng_stream &gen) const;
+        bool louvain_move(const vector<long long> &offset, const vector<int> &adj, const vector<double> &weight, const vector<double> &strength,
+                          double total, double resolution, vector<int> &comm, unsigned long long stream, unsigned int random_seed) const;
+        void louvain_refine(const vector<long long> &offset, const vector<int> &adj, const vector<double> &weight, const vector<double> &strength,
+                            double total, double resolution, const vector<int> &comm, vector<int> &refined, unsigned long long stream, unsigned int random_seed) const;
+        void louvain_aggregate(const vector<long long> &offset, const vector<int> &adj, const vector<double> &weight, const vector<int> &part, int n_parts,
+                               vector<long long> &new_offset, vector<int> &new_adj, vector<double> &new_weight) const;
+        void build_link_csr(vector<long long> &offset, vector<unsigned int> &target, vector<int> &link, bool reverse) const;
+        void dijkstra(int source, const vector<long long> &offset, const vector<unsigned int> &target, const vector<double> &weight,
+                      vector<double> &dist, vector<int> &touched, radix_heap &heap) const;
+        void delta_stepping(int source, double delta, const vector<long long> &offset, const vector<unsigned int> &target,
+                            const vector<double> &weight, vector<double> &dist) const;
+        int bounded_bfs(int source, int comp_label, const vector<int> &component, const vector<long long> &offset,
+                        const vector<unsigned int> &target, vector<int> &dist, vector<int> &touched) const;
+        void build_weighted_csr(vector<long long> &offset, vector<unsigned int> &target, vector<double> &weight) const;
+        void count_shortest_paths(int source, int stop_at, bool weighted, const vector<long long> &offset, const vector<unsigned int> &target,
+                                  const vector<int> &link, const vector<double> &weight, vector<double> &dist, vector<double> &sigma,
+                                  vector<int> &order, vector<int> &touched) const;
+        void ppr_push(int seed, vector< pair<int,double> > &ppr, double alpha, double epsilon, int walks, unsigned int random_seed,
+                      vector<double> &estimate, vector<double> &residual, vector<char> &touched, vector<int> &touched_list, vector<int> &queue) const;
+        double wedge_sampling(const vector<double> &cumulative, int node_index, const vector<unsigned int> &clean,
+                              double &error, int max_samples, double target_error, unsigned int random_seed) const;
+        void degeneracy_ordering(const vector<long long> &offset, const vector<unsigned int> &adj, vector<int> &order) const;
+        int jones_plassmann(const vector<long long> &offset, const vector<unsigned int> &adj, int ordering, unsigned int random_seed,
+                            vector<int> &color, int &rounds) const;
 };
 
 using DCNb = DirectedCNetwork<bool, bool>;
@@ -177,6 +871,7 @@ template <class T, typename B>
 DirectedCNetwork<T,B>::DirectedCNetwork(int max_size)
 {
     directed = true;
+    tracking = false;
     max_net_size = max_size; //Set the max size of the network
     clear_network(); //Initialize everything
     return;
@@ -206,6 +901,8 @@ void DirectedCNetwork<T,B>::clear_network()
     prop_s = map<string, vector<string> >();
 
     value = vector<T>();
+
+    if (tracking) tracker_rebuild();
 
     return;
 }
@@ -250,6 +947,8 @@ void DirectedCNetwork<T,B>::add_nodes(int n)
         neighs.push_back(vector<unsigned int>()); //Add a new container for neighbours
         pointing_in.push_back(vector<unsigned int>()); //And for people pointing to me
     }
+
+    if (tracking) tracker_nodes_added(old_size);
     return;
 }
 
@@ -272,7 +971,7 @@ bool DirectedCNetwork<T,B>::remove_node(int index)
 
         //Re-scale all the neighbours index to fit the net, and also erase
         //the entry of the removed node as neighbour of others
-        for (i=0; i < neighs.size(); i++)
+        for (i=0; i < (int)neighs.size(); i++)
         {
             for (j=0; j < out_degree(i); j++)
             {
@@ -305,25 +1004,25 @@ bool DirectedCNetwork<T,B>::remove_node(int index)
         for (i=0; i < link_count; i++)
         {
             //Separe cases from-to in order to correctly reduce degree
-            if (adjm[i].x == index || adjm[i].y == index)
+            if ((int)adjm[i].x == index || (int)adjm[i].y == index)
             {
                 //Our node is detected, erase the entry to that node
                 who_to_erase.push_back(i);
             }
 
             //Also reduce index of nodes higher than our
-            if (adjm[i].x > index)
+            if ((int)adjm[i].x > index)
             {
                 adjm[i].x -= 1;
             }
-            if (adjm[i].y > index)
+            if ((int)adjm[i].y > index)
             {
                 adjm[i].y -= 1;
             }
         }
 
         //Perform the erase process
-        for (i=0; i < who_to_erase.size(); i++)
+        for (i=0; i < (int)who_to_erase.size(); i++)
         {
             adjm.erase(who_to_erase[i]); //Delete all links
         }
@@ -331,6 +1030,8 @@ bool DirectedCNetwork<T,B>::remove_node(int index)
         link_count -= who_to_erase.size(); //Reduce the number of links
         current_size -= 1; //Reduce the current size of the network in one unit
 
+        comp_dirty = true; //Indices changed, so connectivity must be recomputed
+
         return true;
 
     }
@@ -353,6 +1054,8 @@ void DirectedCNetwork<T,B>::add_link(int from, int to)
     pointing_in[to].push_back(from); //"to" node is being pointed by "from"
 
     link_count += 1; //Create one link more
+
+    if (tracking) tracker_link_added(from, to);
     return;
 }
 
@@ -374,6 +1077,56 @@ void DirectedCNetwork<T,B>::add_link(int from, int to, B w)
 
     link_count += 1; //Create one link more
 
+    if (tracking) tracker_link_added(from, to);
+    return;
+}
+
+
+/** \brief Add many links to the network at once
+*  \param links: list of links, as pairs (from, to)
+*  \param weights: optional. Weight of each link. If empty, links get the same value as in add_link(from, to).
+*
+* Bulk version of add_link, used by the generators. Memory for the links and the lists of neighbours is reserved
+* once, so it is much faster than adding the links one by one. Works for directed and undirected networks.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::add_links(const vector< pair<unsigned int, unsigned int> > &links, const vector<B> &weights)
+{
+    long long i;
+    unsigned int x, y;
+
+    vector<int> extra(current_size, 0);
+
+    //Reserve all the memory first
+    for (i=0; i < (long long)links.size(); i++)
+    {
+        extra[links[i].first] += 1;
+        extra[links[i].second] += 1;
+    }
+    for (i=0; i < current_size; i++)
+    {
+        if (directed)
+        {
+            neighs[i].reserve(neighs[i].size() + extra[i]);
+            pointing_in[i].reserve(pointing_in[i].size() + extra[i]);
+        }
+        else neighs[i].reserve(neighs[i].size() + extra[i]);
+    }
+    adjm.m.reserve(adjm.m.size() + links.size());
+
+    for (i=0; i < (long long)links.size(); i++)
+    {
+        x = links[i].first;
+        y = links[i].second;
+        adjm.push_back(data<B>(x, y, weights.size() > 0 ? weights[i] : (B)true));
+        neighs[x].push_back(y);
+        if (directed) pointing_in[y].push_back(x);
+        else neighs[y].push_back(x);
+    }
+
+    link_count += links.size();
+    if (tracking) comp_dirty = true;
+
     return;
 }
 
@@ -415,6 +1168,7 @@ bool DirectedCNetwork<T,B>::remove_link(int from, int to)
 
         pointing_in[to].erase(pointing_in[to].begin()+index_neigh);
 
+        if (tracking) tracker_link_removed(from, to);
         return true;
     }
     else return false;
@@ -458,6 +1212,7 @@ void DirectedCNetwork<T,B>::remove_link(int index_link)
 
     pointing_in[to].erase(pointing_in[to].begin()+index_neigh);
 
+    if (tracking) tracker_link_removed(from, to);
     return;
 
 }
@@ -632,7 +1387,6 @@ void DirectedCNetwork<T,B>::component_size(vector<int> &node_in_this_component,
 
     vector<bool> visited(current_size, false); //List of visited nodes
     vector<int> dist; //Distance to nodes
-    int result;
 
     i = 0; //Init counters
     k = 0;
@@ -673,27 +1427,402 @@ void DirectedCNetwork<T,B>::component_size(vector<int> &node_in_this_component,
 /** \brief Computes the component with largest size, and return it
 *  \return size of the largest component
 *
-* Use BFS to compute component of network with largest size
+* Components are weakly connected ones, that is, the direction of links is ignored. They are found with weak_components,
+* or returned directly if components are tracked (see track_components), and both give the same answer.
 */
 template <class T, typename B>
 int DirectedCNetwork<T,B>::largest_component_size() const
 {
-    int largest_size = 0;
-    int i;
+    int i, n_comp;
 
-    //Vectors for computing component size
-    vector<int> node_in_this_component;
+    vector<int> component;
     vector<int> size_of_components;
 
-    component_size(node_in_this_component, size_of_components); //Get the size of all components
+    if (tracking)
+    {
+        if (comp_dirty) tracker_rebuild();
+        while (largest_comp > 0 and size_count[largest_comp] == 0) largest_comp -= 1;
+        return largest_comp;
+    }
+
+    if (current_size == 0) return 0;
+
+    n_comp = weak_components(component);
+    size_of_components = vector<int>(n_comp, 0);
+    for (i=0; i < current_size; i++) size_of_components[component[i]] += 1;
 
     return *max_element(size_of_components.begin(), size_of_components.end());
 }
 
-/** \brief Computes the average pathlenght of the network
-*  \return pathlenght of the network.
+/** \brief Keeps the connected components updated while the network changes
+*  \param enable: optional. If true (default) start tracking components, if false stop it.
 *
-* Uses BFS to compute the average pathlenght of the complete network (even if it is disconnected). To compute
+* When enabled, add_link, remove_link, add_nodes and remove_node update a label of the component of every node, so
+* largest_component_size and same_component answer in near-constant time. Components are weakly connected ones, that
+* is, the direction of links is ignored.
+* Adding a link between two components relabels the smaller one. Removing a link starts two searches at its ends,
+* advancing at the same pace: if they meet, nothing changed, and if one of them ends first, it found the part that
+* was split. If both searches get too large, the labels are marked as outdated and rebuilt from scratch at the next
+* query, so a burst of deletions costs a single O(N+E) rebuild.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::track_components(bool enable)
+{
+    tracking = enable;
+    if (tracking) tracker_rebuild();
+    else
+    {
+        comp_label.clear();
+        comp_size.clear();
+        size_count.clear();
+        free_labels.clear();
+        search_mark.clear();
+    }
+    return;
+}
+
+
+/** \brief Checks if two nodes are in the same component
+*  \param a, b: indices of the nodes
+*  \return true if there is a path between a and b, ignoring the direction of links
+*
+* Near-constant time if components are tracked (see track_components). If not, a BFS is done.
+*/
+template <class T, typename B>
+bool DirectedCNetwork<T,B>::same_component(int a, int b) const
+{
+    vector<int> component;
+
+    if (tracking)
+    {
+        if (comp_dirty) tracker_rebuild();
+        return comp_label[a] == comp_label[b];
+    }
+
+    weak_components(component);
+    return component[a] == component[b];
+}
+
+
+/** \brief Computes the labels of the tracked components from scratch
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::tracker_rebuild() const
+{
+    int i, n_comp;
+
+    n_comp = weak_components(comp_label);
+
+    comp_size = vector<int>(current_size, 0);
+    size_count = vector<int>(current_size+1, 0);
+    for (i=0; i < current_size; i++) comp_size[comp_label[i]] += 1;
+    for (i=0; i < n_comp; i++) size_count[comp_size[i]] += 1;
+
+    //Labels not used are kept for future splits
+    free_labels.clear();
+    for (i=current_size-1; i >= n_comp; i--) free_labels.push_back(i);
+
+    largest_comp = 0;
+    for (i=0; i < n_comp; i++) largest_comp = max(largest_comp, comp_size[i]);
+
+    search_mark = vector<int>(current_size, 0);
+    search_stamp = 0;
+    comp_dirty = false;
+    return;
+}
+
+
+/** \brief Updates the tracked components after adding nodes
+*  \param old_size: number of nodes before adding
+*
+* Each new node is a component of size 1 with a new label.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::tracker_nodes_added(int old_size)
+{
+    int i;
+
+    if (comp_dirty) return;
+
+    for (i=old_size; i < current_size; i++)
+    {
+        comp_label.push_back(i);
+        comp_size.push_back(1);
+        size_count.push_back(0);
+        search_mark.push_back(0);
+    }
+    size_count[1] += current_size - old_size;
+    if (current_size > old_size) largest_comp = max(largest_comp, 1);
+
+    return;
+}
+
+
+/** \brief Updates the tracked components after adding a link
+*  \param from, to: ends of the new link
+*
+* Joins the two components, relabelling the nodes of the smaller one with a BFS.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::tracker_link_added(int from, int to)
+{
+    int i, r, v, w;
+    int keep, lose;
+
+    vector<int> queue;
+
+    if (comp_dirty or comp_label[from] == comp_label[to]) return;
+
+    if (comp_size[comp_label[from]] < comp_size[comp_label[to]]) swap(from, to);
+    keep = comp_label[from];
+    lose = comp_label[to];
+
+    //Relabel the smaller component
+    queue.push_back(to);
+    comp_label[to] = keep;
+    r = 0;
+    while (r < (int)queue.size())
+    {
+        v = queue[r];
+        r += 1;
+        for (int side=0; side < 2; side++)
+        {
+            const vector<unsigned int> &list = side == 0 ? neighs[v] : pointing_in[v];
+            if (side == 1 and not directed) break;
+            for (i=0; i < (int)list.size(); i++)
+            {
+                w = list[i];
+                if (comp_label[w] == lose)
+                {
+                    comp_label[w] = keep;
+                    queue.push_back(w);
+                }
+            }
+        }
+    }
+
+    size_count[comp_size[keep]] -= 1;
+    size_count[comp_size[lose]] -= 1;
+    comp_size[keep] += comp_size[lose];
+    comp_size[lose] = 0;
+    size_count[comp_size[keep]] += 1;
+    free_labels.push_back(lose);
+    largest_comp = max(largest_comp, comp_size[keep]);
+
+    return;
+}
+
+
+/** \brief Updates the tracked components after removing a link
+*  \param from, to: ends of the removed link
+*
+* Runs two BFS from the ends, one node at a time each. If one search reaches a node of the other, the component is
+* still connected. If one search ends first, the nodes it visited are a new component, which gets a new label. Searches
+* are stopped after visiting a number of nodes, and then the labels are marked as outdated.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::tracker_link_removed(int from, int to)
+{
+    int i, side, v, w;
+    int budget = max(256, current_size / 64); //Largest number of nodes visited before giving up
+    int label, new_label;
+    bool connected;
+
+    vector<int> queue[2];
+    int r[2] = {0, 0};
+
+    if (comp_dirty or from == to) return;
+
+    //Marks of this search are stamp+1 for nodes found from "from" and stamp+2 for the ones found from "to"
+    if (search_stamp > 2000000000)
+    {
+        search_mark = vector<int>(current_size, 0);
+        search_stamp = 0;
+    }
+    int mark[2] = {search_stamp + 1, search_stamp + 2};
+    search_stamp += 2;
+
+    queue[0].push_back(from);
+    queue[1].push_back(to);
+    search_mark[from] = mark[0];
+    search_mark[to] = mark[1];
+
+    connected = false;
+    side = 0;
+    while (not connected and r[0] < (int)queue[0].size() and r[1] < (int)queue[1].size())
+    {
+        if ((int)(queue[0].size() + queue[1].size()) > budget)
+        {
+            comp_dirty = true;
+            return;
+        }
+
+        //Expand one node of this side
+        v = queue[side][r[side]];
+        r[side] += 1;
+        for (int dir=0; dir < 2 and not connected; dir++)
+        {
+            if (dir == 1 and not directed) break;
+            const vector<unsigned int> &list = dir == 0 ? neighs[v] : pointing_in[v];
+            for (i=0; i < (int)list.size() and not connected; i++)
+            {
+                w = list[i];
+                if (search_mark[w] == mark[1-side]) connected = true;
+                else if (search_mark[w] != mark[side])
+                {
+                    search_mark[w] = mark[side];
+                    queue[side].push_back(w);
+                }
+            }
+        }
+        side = 1 - side;
+    }
+
+    if (connected) return;
+
+    //The side whose search ended is split away
+    side = r[0] >= (int)queue[0].size() ? 0 : 1;
+    label = comp_label[from];
+    new_label = free_labels.back();
+    free_labels.pop_back();
+
+    for (i=0; i < (int)queue[side].size(); i++) comp_label[queue[side][i]] = new_label;
+
+    size_count[comp_size[label]] -= 1;
+    comp_size[label] -= queue[side].size();
+    comp_size[new_label] = queue[side].size();
+    size_count[comp_size[label]] += 1;
+    size_count[comp_size[new_label]] += 1;
+
+    return;
+}
+
+
+/** \brief Extracts the subgraph induced by a set of nodes
+*  \param nodes: nodes to keep. Their order gives the new indices, and repeated nodes are ignored.
+*  \param[out] sub: network where the subgraph is written. Its previous contents are deleted. It must be a different
+*  object, of the same kind (directed or not) as this one. Otherwise a warning is shown and sub is not modified.
+*  \param[out] new_index: element j is the index of node j in the subgraph, or -1 if it was not kept
+*
+* Keeps all links between the selected nodes, with their weights, and copies the values of the nodes and the node and
+* link property columns. The subgraph is written directly: one pass over the links and a bulk build of the neighbours,
+* without add_link. Use weak_components or component_nodes to get, for example, the giant component.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::induced_subgraph(const vector<int> &nodes, DirectedCNetwork<T,B> &sub, vector<int> &new_index) const
+{
+    int i, n;
+    unsigned int x, y;
+
+    vector<int> kept_nodes, kept_links;
+
+    new_index = vector<int>(current_size, -1);
+
+    //Directed and undirected networks store the neighbours differently, so the subgraph cannot be written
+    if (sub.directed != directed)
+    {
+        cout << "WARNING [DirectedCNetwork]: induced_subgraph between a directed and an undirected network. Nothing done." << endl;
+        return;
+    }
+
+    for (i=0; i < (int)nodes.size(); i++)
+    {
+        if (new_index[nodes[i]] < 0)
+        {
+            new_index[nodes[i]] = kept_nodes.size();
+            kept_nodes.push_back(nodes[i]);
+        }
+    }
+    n = kept_nodes.size();
+
+    sub.max_net_size = max(sub.max_net_size, n);
+    sub.current_size = n;
+    sub.adjm = SparseMatrix<B>(sub.max_net_size, not sub.directed);
+
+    for (i=0; i < link_count; i++)
+    {
+        x = adjm.m[i].x;
+        y = adjm.m[i].y;
+        if (new_index[x] >= 0 and new_index[y] >= 0)
+        {
+            sub.adjm.push_back(data<B>(new_index[x], new_index[y], adjm.m[i].value));
+            kept_links.push_back(i);
+        }
+    }
+    sub.link_count = kept_links.size();
+
+    sub.value = vector<T>(n);
+    for (i=0; i < n; i++) sub.value[i] = value[kept_nodes[i]];
+
+    sub.neighs = vector< vector<unsigned int> >(n);
+    sub.pointing_in = vector< vector<unsigned int> >(sub.directed ? n : 0);
+    sub.rebuild_neighbours();
+
+    copy_property_columns(prop_d, sub.prop_d, current_size, link_count, kept_nodes, kept_links);
+    copy_property_columns(prop_i, sub.prop_i, current_size, link_count, kept_nodes, kept_links);
+    copy_property_columns(prop_b, sub.prop_b, current_size, link_count, kept_nodes, kept_links);
+    copy_property_columns(prop_s, sub.prop_s, current_size, link_count, kept_nodes, kept_links);
+
+    if (sub.tracking) sub.tracker_rebuild();
+
+    return;
+}
+
+
+/** \brief Extracts the ego network of a node
+*  \param node_index: central node, which is node 0 of the result
+*  \param radius: nodes at distance up to radius from the center are kept
+*  \param[out] sub: network where the ego network is written, as in induced_subgraph
+*  \param[out] new_index: element j is the index of node j in the ego network, or -1 if it was not kept
+*
+* Distances ignore the direction of links. The BFS only visits the nodes kept, so it does not depend on the size of
+* the network, apart from the final pass over the links in induced_subgraph.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::ego_network(int node_index, int radius, DirectedCNetwork<T,B> &sub, vector<int> &new_index) const
+{
+    int i, r, v, w;
+
+    vector<int> queue, dist;
+    map<int,int> found; //Distance of the nodes visited, without allocating N elements
+
+    queue.push_back(node_index);
+    dist.push_back(0);
+    found[node_index] = 0;
+    r = 0;
+    while (r < (int)queue.size())
+    {
+        v = queue[r];
+        if (dist[r] < radius)
+        {
+            for (int side=0; side < 2; side++)
+            {
+                if (side == 1 and (not directed or v >= (int)pointing_in.size())) break;
+                const vector<unsigned int> &list = side == 0 ? neighs[v] : pointing_in[v];
+                for (i=0; i < (int)list.size(); i++)
+                {
+                    w = list[i];
+                    if (found.count(w) == 0)
+                    {
+                        found[w] = dist[r] + 1;
+                        queue.push_back(w);
+                        dist.push_back(dist[r] + 1);
+                    }
+                }
+            }
+        }
+        r += 1;
+    }
+
+    induced_subgraph(queue, sub, new_index);
+    return;
+}
+
+
+/** \brief Computes the average pathlenght of the network
+*  \return pathlenght of the network.
+*
+* Uses BFS to compute the average pathlenght of the complete network (even if it is disconnected). To compute
 * pathlenght of single network component, use average_pathlenght_component instead
 */
 template <class T, typename B>
@@ -756,11 +1885,11 @@ double DirectedCNetwork<T,B>::average_pathlenght_component(int component_index,
 
     counter = 0;
     pathlength = 0.0;
-    for (i=0; i < cluster_index.size(); i++)
+    for (i=0; i < (int)cluster_index.size(); i++)
     {
         index = cluster_index[i];
         breadth_first_search(index, node_list, dist); //Now compute distances
-        for (j=0; j < cluster_index.size(); j++)
+        for (j=0; j < (int)cluster_index.size(); j++)
         {
             if (cluster_index[j] != index)
             {
@@ -774,743 +1903,5521 @@ double DirectedCNetwork<T,B>::average_pathlenght_component(int component_index,
     return (counter > 0) ? pathlength / (1.0 * counter) : -1.0; //Return the average pathlenght of the network
 }
 
-/** \brief Computes the degree distribution of the network
-*  \param[out] distribution: index j contains number of nodes with degree j. It is the degree distribution
-*  \param type: kind of average to take: IN_DEGREE, OUT_DEGREE, or TOTAL_DEGREE
-*  \param normalized: optional. If set to true, returns a normalized distribution. False by default.
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Builds a compact adjacency with the weight of each link
+*  \param[out] offset: links of node j are stored between offset[j] and offset[j+1]
+*  \param[out] target: node at the other end of each link
+*  \param[out] weight: weight of each link, from adjm
 *
-* Compute the degree distribution of the network. If you also need the correlations, please use instead degree_correlation.
+* Same as build_link_csr, but storing the weight next to the target so the shortest path routines read memory
+* sequentially. Warns if there are negative weights, which are not allowed for shortest paths.
 */
-template <class T, typename B>
-void DirectedCNetwork<T,B>::degree_distribution(vector<int> &distribution, int type, bool normalized) const
-{
-    int i;
-    distribution = vector<int>(current_size, 0);
+template <class T, typename B>
+void DirectedCNetwork<T,B>::build_weighted_csr(vector<long long> &offset, vector<unsigned int> &target, vector<double> &weight) const
+{
+    long long k;
+    bool negative = false;
 
-    //Select in, out, or full degree distribution and compute it:
-    if (type == 0) for (i=0; i < current_size; i++) distribution[in_degree(i)] += 1;
-    else if (type == 1) for (i=0; i < current_size; i++) distribution[out_degree(i)] += 1;
-    else for (i=0; i < current_size; i++) distribution[degree(i)] += 1;
-
-    //Erase the 0s at the end of the array.
-    i = current_size - 1; //Start counter
-    while (distribution[i] == 0)
-    {
-        //distribution.erase(distribution.begin() + i);
-        distribution.pop_back();
-        i -= 1;
+    vector<int> link;
+
+    build_link_csr(offset, target, link, false);
+    weight = vector<double>(link.size());
+    for (k=0; k < (long long)link.size(); k++)
+    {
+        weight[k] = adjm.m[link[k]].value;
+        negative = negative or weight[k] < 0.0;
     }
 
-    //Normalize the distribution if it has been indicated
-    if (normalized)
+    if (negative) cout << "WARNING [DirectedCNetwork]: negative weights found, shortest paths will be wrong" << endl;
+
+    return;
+}
+
+
+/** \brief Weighted distances from a single node, using Dijkstra's algorithm
+*  \param source: index of the origin node
+*  \param offset, target, weight: adjacency given by build_weighted_csr
+*  \param dist: workspace. Must be filled with -1 before the call. Gets the distance to every reached node.
+*  \param[out] touched: list of nodes reached. Callers reset dist only at these nodes, so the workspace can be reused.
+*  \param heap: workspace. Empty radix heap.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::dijkstra(int source, const vector<long long> &offset, const vector<unsigned int> &target, const vector<double> &weight,
+                                     vector<double> &dist, vector<int> &touched, radix_heap &heap) const
+{
+    long long k;
+    int v, w;
+    double d;
+    pair<double,int> top;
+
+    touched.clear();
+    heap.clear();
+
+    dist[source] = 0.0;
+    touched.push_back(source);
+    heap.push(0.0, source);
+    while (not heap.empty())
     {
-        for (i=0; i < distribution.size(); i++)
+        top = heap.pop();
+        v = top.second;
+        if (top.first > dist[v]) continue; //Old entry, already settled with a shorter distance
+
+        for (k=offset[v]; k < offset[v+1]; k++)
         {
-            distribution[i] /= link_count;
+            w = target[k];
+            d = dist[v] + weight[k];
+            if (dist[w] < 0.0 or d < dist[w])
+            {
+                if (dist[w] < 0.0) touched.push_back(w);
+                dist[w] = d;
+                heap.push(d, w);
+            }
         }
-    }
-    return;
-}
-
+    }
 
-/** \brief Computes the degree distribution and correlations
-*  \param[out] distribution: index j contains number of nodes with degree j. It is the degree distribution
-*  \param[out] correlation: index j contains average degree of neighbours of a node with degree j
-*  \param type: kind of average to take: IN_DEGREE, OUT_DEGREE, or TOTAL_DEGREE
-*  \param normalized: optional. If set to true, returns a normalized distribution. False by default.
-*
-* Computes the average number of neighbours that a node with degree j has. It also computes and stores the degree distribution,
-* since both quantities are usually needed.
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::degree_correlation(vector<int> &distribution, vector<double> &correlation, int type, bool normalized) const
-{
-    int i,j,k;
-    int index, numneighs;
-    double mean_neigh_degree; //Average degree of the neighbour of a node
-
-    int maxdegree = 0;
+    return;
+}
 
-    int (DirectedCNetwork<T,B>::*deg_fun)(int);
-    int(DirectedCNetwork<T,B>::*neigh_fun)(int,int);
 
-    //Gets the correct function for computing degrees
-    if (type == 0)
-    {
-        deg_fun = &DirectedCNetwork<T,B>::in_degree;
-        neigh_fun = &DirectedCNetwork<T,B>::get_in;
-    }
-    else if (type == 1)
-    {
-        deg_fun = &DirectedCNetwork<T,B>::out_degree;
-        neigh_fun = &DirectedCNetwork<T,B>::get_out;
-    }
-    else
-    {
-        deg_fun = &DirectedCNetwork<T,B>::degree;
-        neigh_fun = &DirectedCNetwork<T,B>::get_out;
-    }
-
-    //Get the maximum degree of the network
-    if (type == 0)
+/** \brief Weighted distances from a single node, using parallel delta-stepping
+*  \param source: index of the origin node
+*  \param delta: width of the buckets
+*  \param offset, target, weight: adjacency given by build_weighted_csr
+*  \param[out] dist: distance to every node, -1 if not reachable
+*
+* Nodes are kept in buckets of width delta. All nodes in the current bucket relax their light links (weight <= delta)
+* at the same time, repeating until the bucket is empty, and then heavy links are relaxed once. Relaxations are computed
+* in parallel and applied afterwards, so the result does not depend on the number of threads.
+* Only buckets up to the largest weight ahead of the current one can be filled, so they are reused cyclically. delta is
+* raised to at least the largest weight / 2^20 to bound their number.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::delta_stepping(int source, double delta, const vector<long long> &offset, const vector<unsigned int> &target,
+                                           const vector<double> &weight, vector<double> &dist) const
+{
+    int i, j;
+    long long b, n_buckets, empty_run;
+    int stamp;
+    double max_weight;
+    const double inf = numeric_limits<double>::infinity();
+
+    vector< vector<int> > bucket;
+    vector<int> frontier, settled;
+    vector<int> mark(current_size, -1); //Last round in which the node was in the frontier
+    vector<bool> in_settled(current_size, false);
+    vector< pair<int,double> > requests;
+
+    max_weight = weight.size() > 0 ? *max_element(weight.begin(), weight.end()) : 0.0;
+    delta = max(delta, max_weight / 1048576.0);
+    n_buckets = (long long)(max_weight / delta) + 2;
+    bucket = vector< vector<int> >(n_buckets);
+
+    dist = vector<double>(current_size, inf);
+    dist[source] = 0.0;
+    bucket[0].push_back(source);
+
+    //Bucket b is stored in b % n_buckets. Finish when a full cycle of buckets is empty
+    stamp = 0;
+    empty_run = 0;
+    for (b=0; empty_run < n_buckets; b++)
     {
-        for (i=0; i < current_size; i++)
-        {
-            if (degree(i) > maxdegree)
-            {
-                maxdegree = (this->*deg_fun)(i);
-            }
+        vector<int> &current = bucket[b % n_buckets];
+        if (current.empty())
+        {
+            empty_run += 1;
+            continue;
         }
-    }
-
-
-    //Use it to create containers able to handle the distribution
-    correlation = vector<double>(maxdegree, 0.0);
-    distribution = vector<int>(maxdegree, 0);
-
-    //Now compute the distributions depending on
-    for (i=0; i < current_size; i++)
-    {
-        index = (this->*deg_fun)(i); //Get the index of the vector of distribution
-        distribution[index] += 1; //And set that it has one count more
-
-        numneighs = index; //num_neighs has to be equal to the degree
-        mean_neigh_degree = 0.0;
-        for (j=0; j < numneighs; j++)
-        {
-            k = (this->*neigh_fun)(i,j); //Get index of the neigh
-            mean_neigh_degree += deg_fun(k); //Add its degree
-        }
-        if (numneighs != 0) mean_neigh_degree /= 1.0 * numneighs; //Finish the average
-        correlation[index] += mean_neigh_degree; //Put it into the distribution
-    }
-
-    //To finish average over nodes, divide by the number of nodes with degree k
-    //This are in distribution. Check that we are not dividing by 0
-    for (i=0; i < correlation.size(); i++)
-    {
-        if (distribution[i] != 0) correlation[i] /= 1.0*distribution[i];
-    }
+        empty_run = 0;
 
-    if (normalized)
-    {
-        for (i=0; i < distribution.size(); i++)
+        settled.clear();
+        for (int heavy=0; heavy < 2; heavy++)
         {
-            distribution[i] /= link_count;
+            while (heavy == 1 or not current.empty())
+            {
+                if (heavy == 0)
+                {
+                    //Nodes still in this bucket, without repetitions
+                    frontier.clear();
+                    for (j=0; j < (int)current.size(); j++)
+                    {
+                        int v = current[j];
+                        if (mark[v] != stamp and (long long)(dist[v] / delta) == b)
+                        {
+                            mark[v] = stamp;
+                            frontier.push_back(v);
+                            if (not in_settled[v])
+                            {
+                                in_settled[v] = true;
+                                settled.push_back(v);
+                            }
+                        }
+                    }
+                    current.clear();
+                    stamp += 1;
+                }
+                else frontier.swap(settled);
+
+                requests.clear();
+                #pragma omp parallel
+                {
+                    vector< pair<int,double> > local;
+
+                    #pragma omp for schedule(dynamic, 64) nowait
+                    for (i=0; i < (int)frontier.size(); i++)
+                    {
+                        int v = frontier[i];
+                        for (long long k=offset[v]; k < offset[v+1]; k++)
+                        {
+                            if ((weight[k] <= delta) == (heavy == 0))
+                            {
+                                double d = dist[v] + weight[k];
+                                if (d < dist[target[k]]) local.push_back(make_pair(target[k], d));
+                            }
+                        }
+                    }
+
+                    #pragma omp critical
+                    requests.insert(requests.end(), local.begin(), local.end());
+                }
+
+                //Apply the relaxations
+                for (j=0; j < (int)requests.size(); j++)
+                {
+                    int w = requests[j].first;
+                    double d = requests[j].second;
+                    if (d < dist[w])
+                    {
+                        dist[w] = d;
+                        bucket[(long long)(d / delta) % n_buckets].push_back(w);
+                    }
+                }
+
+                if (heavy == 1)
+                {
+                    for (j=0; j < (int)frontier.size(); j++) in_settled[frontier[j]] = false;
+                    break;
+                }
+            }
         }
-    }
-
-    return;
-}
-
-// ========================================================================================================
-// ========================================================================================================
-// ========================================================================================================
+    }
 
-// ========================================================================================================
-// ========================================================================================================
-// ========================================================================================================
+    for (i=0; i < current_size; i++) if (dist[i] == inf) dist[i] = -1.0;
 
+    return;
+}
 
 
-/** \brief Generates a random Erdos-Renyi network
-*  \param nodes: nodes of the network
-*  \param mean_k: average degree
-*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+/** \brief Weighted distances from a single node
+*  \param source: index of the origin node
+*  \param[out] dist: element j is the sum of weights along the shortest path to node j, or -1 if j cannot be reached
+*  \param delta: optional. If 0 (default), use Dijkstra's algorithm with a radix heap. If positive, use parallel
+*  delta-stepping with buckets of this width. A good choice is the mean weight divided by the mean degree.
 *
-* Generates an Erdos-Renyi network. The random seed should be specified for obtaining different networks each iteration.
+* Weights are taken from adjm and must be non-negative. Paths follow the direction of links in directed networks.
 */
-template <class T, typename B>
-void DirectedCNetwork<T,B>::create_erdos_renyi(int n, double mean_k, unsigned int random_seed)
+template <class T, typename B>
+void DirectedCNetwork<T,B>::weighted_distances(int source, vector<double> &dist, double delta) const
 {
-    //TODO: make faster. MAKE SAFER
-
-    int i,j,k;
-    double p = mean_k / (n - 1.0);
-    double phalf = p/2.0; //Compute half of the probability
+    vector<long long> offset;
+    vector<unsigned int> target;
+    vector<double> weight;
+    vector<int> touched;
+    radix_heap heap;
 
-    double r;
-
-    mt19937 gen(random_seed);; //Create the generator
-    uniform_real_distribution<double> ran_u(0.0,1.0); //Uniform number distribution
-    uniform_int_distribution<int>  index(0,n-1); //-1 because closed interval for ints
-
-    add_nodes(n); //Create the nodes
-
-    //For the n (n-1) / 2 pairs, link them with probability p
-    for (i=0; i < current_size; i++)
-    {
-        for (j=i+1; j < current_size; j++)
-        {
-            r = ran_u(gen);
-            //With probability p, add link. With probability 1/2, select if the link goes out or in
-            if (r <= phalf) add_link(i, j);
-            else if (r <= p) add_link(j, i);
-        }
-    }
-
-    return;
-
-}
+    build_weighted_csr(offset, target, weight);
+
+    if (delta > 0.0) delta_stepping(source, delta, offset, target, weight, dist);
+    else
+    {
+        dist = vector<double>(current_size, -1.0);
+        dijkstra(source, offset, target, weight, dist, touched, heap);
+    }
 
+    return;
+}
 
 
-/** \brief Generates a scale-free network using the configurational model
-*  \param nodes: nodes of the network
-*  \param kmin: minimum degree of each node
-*  \param gamma: exponent of power law
-*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+/** \brief Weighted distances from several nodes
+*  \param sources: list of origin nodes. If empty, all nodes are used.
+*  \param[out] dist: element j is the list of distances from sources[j] to all nodes, -1 if not reachable
 *
-* Generates a scale free network based using the configuration model. The random seed should be
-* specified for obtaining different networks each iteration.
+* The adjacency is built only once and each thread reuses its workspace between sources, cleaning only the nodes
+* reached in the previous search. Sources are computed in parallel.
 */
-template <class T, typename B>
-void DirectedCNetwork<T,B>::create_configurational(int n, int mink, double gamma, unsigned int random_seed)
-{
-    int i,j;
-    int n_links;
-    int max_size; //Maximum size if we want an uncorrelated network
-
-    vector<int> node_degree;
-    vector<int> link_vector;
-
-    mt19937 gen(random_seed); //Create the generator
-    uniform_real_distribution<double> ran_u(0.0,1.0); //Uniform number distribution
-
-    add_nodes(n); //Add the nodes we need
-    node_degree = vector<int>(current_size); //Store degree of every node
-    max_size = sqrt(current_size); //Max size to avoid correlatons
-
-    n_links = 0; //There's no link yet
-
-    //Compute all the quantities we need to generate the degrees,
-    double kmax = pow(max_size, 1.0-gamma);
-    double kmin = pow(mink, 1.0-gamma);
-    double invgamma = 1.0 / (1.0 - gamma);
-
-
-    for (i=0; i < current_size; i++)
-    {
-        node_degree[i] = floor( pow( ran_u(gen)*(kmax - kmin) + kmin, invgamma ) ); //Generate degrees
-        n_links += node_degree[i]; //Update number of links
-    }
-
-    //Make sure we have even number of links
-    if (n_links % 2 == 1)
-    {
-        node_degree[0] += 1;
-        n_links += 1;
-    }
-
-    link_vector = vector<int>(n_links); //Initalize the vector which will create the links
-
-    int k=0;
-    for (i=0; i < current_size; i++)
-    {
-        //Put index i a number ki of times
-        for (j=0; j < node_degree[i]; j++)
-        {
-            link_vector[k] = i;
-            k += 1;
-        }
-    }
-
-    random_shuffle(link_vector.begin(), link_vector.end()); //Make a shuffle
-
-    //Now create links using shuffled pairs, and that's all
-    for (i=0; i < link_vector.size()/2; i++)
-    {
-        if (link_vector[2*i] != link_vector[2*i+1])
-        {
-            add_link(link_vector[2*i], link_vector[2*i+1]);
-        }
-    }
-
-    return;
-
-}
+template <class T, typename B>
+void DirectedCNetwork<T,B>::weighted_distances(const vector<int> &sources, vector< vector<double> > &dist) const
+{
+    int i;
+    int n_sources = sources.size() > 0 ? sources.size() : current_size;
 
+    vector<long long> offset;
+    vector<unsigned int> target;
+    vector<double> weight;
 
+    build_weighted_csr(offset, target, weight);
 
-/** \brief Generates a Watts-Strogatz network
-*  \param nodes: nodes of the network
-*  \param regular_connections: degree of each node in the case p=0
-*  \param p: probability of shuffling edges
-*  \param random_seed: optional, default 123456789. Same seed gives the same network.
-*
-* Generates a Watts-Strogatz network. In the case of a completely regular network (p=0), each node
-* has regular_connections edges. The random seed should be specified for obtaining different networks each iteration.
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::create_watts_strogatz(int n, int num_forward_edges, double p, unsigned int random_seed)
-{
-    int i,j;
-    int to;
-    mt19937 gen(random_seed);; //Create the generator
-    uniform_real_distribution<double> ran_u(0.0,1.0); //Uniform number distribution
-    uniform_int_distribution<int>  index(0,n-1); //-1 because closed interval for ints
-    vector<unsigned int> aux;
-    bool eliminated;
+    dist = vector< vector<double> >(n_sources);
 
+    #pragma omp parallel
+    {
+        vector<double> d(current_size, -1.0);
+        vector<int> touched;
+        radix_heap heap;
 
-    clear_network();
-    ///TODO check for reg_connections = 0, warn the user
-
-    //Add the nodes
-    add_nodes(n);
-
-    for (i=0; i < current_size; i++)
-    {
-        for (j=1; j <= num_forward_edges; j++) //At least one node.
+        #pragma omp for schedule(dynamic, 16)
+        for (i=0; i < n_sources; i++)
         {
-            if (ran_u(gen) > p) add_link(i, (i+j)%current_size); //Add the link
-            else
-            {
-                do
-                {
-                    to = index(gen); //Get a new neighbour
-                    aux = get_neighs_out(i);
-                }
-                //Do it again if I selected exactly the same node, or if it is myself
-                while (to == i && find(aux.begin(), aux.end(), to) != aux.end());
-                add_link(i, to);
-            }
-        }
-    }
-
-    return;
-}
-
+            dijkstra(sources.size() > 0 ? sources[i] : i, offset, target, weight, d, touched, heap);
+            dist[i] = d;
+            for (int j=0; j < (int)touched.size(); j++) d[touched[j]] = -1.0;
+        }
+    }
 
-/** \brief Generates an Albert-Barabasi network
-*  \param n: nodes of the network
-*  \param m0: initial number of fully-connected nodes
-*  \param m: new links added for each node
-*  \param random_seed: optional, default 123456789. Same seed gives the same network.
-*
-* Generates an Albert-Barabasi network based in the algorithm given by Newman. The random seed should be
-* specified for obtaining different networks each iteration.
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::create_albert_barabasi(int n, int m0, int m, unsigned int random_seed)
-{
-    int i,j,k,l;
-    double r;
-
-    mt19937 gen(random_seed);; //Create the generator
-    uniform_real_distribution<double> random(0.0,1.0); //Uniform number distribution
-    uniform_int_distribution<int>  index(0,1); //Useful to select indices
-
-    int index_add;
-    vector<int> yet_linked(m-1, -1); //Stores with which nodes I have visited. I only need to remember m-1 -I don't have to store the last
-    bool found;
-
-    //Create fully connected network with m0 nodes
-    add_nodes(m0);
-    for (i=0; i < m0; i++)
-    {
-        for (j=i+1; j < m0; j++)
-        {
-            add_link(i,j);
-        }
-    }
-
-    //Add then more nodes...
-    for (i = m0; i < n; i++)
-    {
-        add_nodes(1);
-
-        yet_linked = vector<int>(m-1, -1);
-        k = 0;
-        //For every link we want to do,
-        for (j=0; j < m; j++)
-        {
-            //Generate a random number
-            if (random(gen) <= 0.5)
-            {
-                //With half probability, add it to highly connected node, selecting randomly an edge.
-                index = uniform_int_distribution<int>(0, link_count-1);//-1 because interval is closed
-                index_add = adjm[index(gen)].y;
-
-            }
-            else
-            {
-                //If not, connect to a random node
-                index = uniform_int_distribution<int>(0, current_size-2); //We don't want current_size-1 which is the actual node, so up to -2
-                index_add = index(gen);
-            }
-
-            //Check there that we don't have still a link between the two...
-            found = false;
-            l = 0;
-            while (l < m-1 && !found && yet_linked[l] != -1) //Remember yet_linked.size = m - 1 always
-            {
-                found = index_add == yet_linked[l];
-                l++;
-            }
-            //If there is no previous link between both, then add it.
-            if (!found)
-            {
-                add_link(current_size-1, index_add); //Add the link
-                yet_linked[k] = index_add; //Say we explored it
-                k++; //To fill next vector element
-            }
-
-        }
-    }
-
-    return;
-}
-
-// ========================================================================================================
-// ========================================================================================================
-// ========================================================================================================
+    return;
+}
 
-// ========================================================================================================
-// ========================================================================================================
-// ========================================================================================================
 
-/** \brief Gets the in-degree of the target node
-*  \param node_index: target node
-*  \return in-degree of target node
+/** \brief Computes the weighted average pathlength and the weighted diameter
+*  \param[out] diameter: largest weighted distance between two connected nodes
+*  \return average of the weighted distances between all pairs of connected nodes, or -1 if there are none
 *
-* Returns the in-degree of the target node
+* Runs Dijkstra from every node in parallel, reusing the workspace of each thread. Memory is linear in the size of
+* the network. Pairs which are not connected are ignored, as in average_pathlenght.
 */
-template <class T, typename B>
-int DirectedCNetwork<T,B>::in_degree(int node_index) const
+template <class T, typename B>
+double DirectedCNetwork<T,B>::weighted_average_pathlength(double &diameter) const
 {
-    return pointing_in[node_index].size();
-}
+    int i;
+    long long counter = 0;
+    double pathlength = 0.0;
 
-/** \brief Gets the out-degree of the target node
-*  \param node_index: target node
-*  \return out-degree of target node
-*
-* Returns the out-degree of the target node
-*/
-template <class T, typename B>
-int DirectedCNetwork<T,B>::out_degree(int node_index) const
-{
-    return neighs[node_index].size();
-}
+    vector<long long> offset;
+    vector<unsigned int> target;
+    vector<double> weight;
 
+    build_weighted_csr(offset, target, weight);
 
-/** \brief Gets the degree of the target node
-*  \param node_index: target node
-*  \return degree of target node
-*
-* Returns the degree of the target node
-*/
-template <class T, typename B>
-int DirectedCNetwork<T,B>::degree(int node_index) const
-{
-    return pointing_in[node_index].size() + neighs[node_index].size();
-}
-
-/** \brief Gets a link between two specified nodes
-*  \param from: origin node
-*  \param to: destination node
-*  \return index of the link between from and destination.
-*
-* Returns the index of the link that connects nodes from and to. If there is no link, then
-* it returns -1.
-*/
-template <class T, typename B>
-int DirectedCNetwork<T,B>::get_link_index(int from, int to) const
-{
-    int i,even,odd;
-    bool found = false;
-
-    i = 0;
-    while (i < link_count and not found)
-    {
-        found = (adjm[i].x == from and adjm[i].y == to);
-        i += 1;
-    }
-
-    return found ? i-1 : -1; //Remember we have just summed i
-}
+    diameter = 0.0;
 
+    #pragma omp parallel reduction(+:pathlength,counter)
+    {
+        vector<double> d(current_size, -1.0);
+        vector<int> touched;
+        radix_heap heap;
+        double local_diameter = 0.0;
 
-/** \brief Gets a link by its index
-*  \param link_index: index of target link
-*  \return vector containing origin and target node indices
-*
-* Returns a vector (node_origin, node_destination) given the link index
-*/
-template <class T, typename B>
-vector<int> DirectedCNetwork<T,B>::get_link(int link_index) const
-{
-    return {adjm[link_index].x, adjm[link_index].y};
-}
+        #pragma omp for schedule(dynamic, 16)
+        for (i=0; i < current_size; i++)
+        {
+            dijkstra(i, offset, target, weight, d, touched, heap);
+            for (int j=1; j < (int)touched.size(); j++) //First one is the source
+            {
+                pathlength += d[touched[j]];
+                local_diameter = max(local_diameter, d[touched[j]]);
+            }
+            counter += touched.size() - 1;
+            for (int j=0; j < (int)touched.size(); j++) d[touched[j]] = -1.0;
+        }
 
+        #pragma omp critical
+        diameter = max(diameter, local_diameter);
+    }
 
-/** \brief Gets a link weight
-*  \param link_index: index of target link
-*  \return link weight
-*
-* Returns the object ("weight") associated with the specified link
-*/
-template <class T, typename B>
-B DirectedCNetwork<T,B>::get_weight(int link_index) const
-{
-    return adjm[link_index].value;
+    return (counter > 0) ? pathlength / (1.0 * counter) : -1.0;
 }
 
 
-/** \brief Gets a link weight
-*  \param link_index: index of target link
-*  \param weight: desired weight of the link
+/** \brief Computes the exact diameter, radius and eccentricities of the largest component
+*  \param[out] radius: smallest eccentricity in the component
+*  \param[out] eccentricity: element j is the eccentricity of node j. Nodes outside the component get -1.
+*  \param all_eccentricities: optional. If false, stop as soon as diameter and radius are known. Then nodes whose
+*  eccentricity was not needed get -1.
+*  \return diameter of the component
 *
-* Sets the object ("weight") associated with the specified link
+* Uses the bounding algorithm of Takes and Kosters. Each node keeps a lower and upper bound of its eccentricity, and
+* a BFS from node v tightens all of them, since ecc(w) >= max(d(w,v), ecc(v) - d(v,w)) and ecc(w) <= d(w,v) + ecc(v).
+* BFS sources alternate between the largest upper bound and the smallest lower bound, starting by the hub, and nodes
+* whose bounds are equal, or which cannot change diameter or radius, are dropped. On real networks this needs a few
+* tens of BFS instead of one per node.
+* Undirected networks use their largest connected component. Directed ones use the largest strongly connected
+* component and distances along the direction of links, with one forward and one backward BFS per step.
 */
 template <class T, typename B>
-void DirectedCNetwork<T,B>::set_weight(int link_index, B weight) const
+int DirectedCNetwork<T,B>::diameter(int &radius, vector<int> &eccentricity, bool all_eccentricities) const
 {
-    adjm[link_index].value = weight;
-    return;
-}
+    int i, j;
+    int v, ecc_v, turn;
+    int largest, n_comp;
+    int d_low, d_up, r_low, r_up;
+
+    vector<long long> offset, in_offset;
+    vector<unsigned int> target, in_target;
+    vector<int> link;
+    vector<int> component, comp_size;
+    vector<int> candidates, lower, upper;
+    vector<int> fwd, bwd, fwd_touched, bwd_touched;
+
+    eccentricity = vector<int>(current_size, -1);
+    radius = 0;
+    if (current_size == 0) return 0;
+
+    //Find the largest component
+    n_comp = directed ? strong_components(component) : weak_components(component);
+    comp_size = vector<int>(n_comp, 0);
+    for (i=0; i < current_size; i++) comp_size[component[i]] += 1;
+    largest = max_element(comp_size.begin(), comp_size.end()) - comp_size.begin();
+
+    build_link_csr(offset, target, link, false);
+    if (directed) build_link_csr(in_offset, in_target, link, true);
+
+    lower = vector<int>(current_size, 0);
+    upper = vector<int>(current_size, current_size);
+    for (i=0; i < current_size; i++) if (component[i] == largest) candidates.push_back(i);
+
+    fwd = vector<int>(current_size, -1);
+    if (directed) bwd = vector<int>(current_size, -1);
+    const vector<int> &back = directed ? bwd : fwd; //Distances to the source. Same as from it in undirected networks
+
+    d_low = 0;
+    r_up = current_size;
+    turn = 0;
+    while (candidates.size() > 0)
+    {
+        //Select the next source, breaking ties by degree
+        v = candidates[0];
+        for (j=1; j < (int)candidates.size(); j++)
+        {
+            int w = candidates[j];
+            bool better;
+            if (turn % 2 == 0) better = upper[w] > upper[v] or (upper[w] == upper[v] and offset[w+1]-offset[w] > offset[v+1]-offset[v]);
+            else better = lower[w] < lower[v] or (lower[w] == lower[v] and offset[w+1]-offset[w] > offset[v+1]-offset[v]);
+            if (better) v = w;
+        }
+        turn += 1;
 
+        ecc_v = bounded_bfs(v, largest, component, offset, target, fwd, fwd_touched);
+        if (directed) bounded_bfs(v, largest, component, in_offset, in_target, bwd, bwd_touched);
 
-/** \brief Total number of nodes in the network
-*  \return number of nodes in the network
-*
-* Returns the total number of nodes initialized in the network
-*/
-template <class T, typename B>
-int DirectedCNetwork<T,B>::get_node_count() const
-{
-    return current_size;
-}
+        eccentricity[v] = ecc_v;
+        d_low = max(d_low, ecc_v);
+        r_up = min(r_up, ecc_v);
 
+        //Update bounds and drop resolved nodes
+        d_up = d_low;
+        r_low = r_up;
+        j = 0;
+        for (i=0; i < (int)candidates.size(); i++)
+        {
+            int w = candidates[i];
+            if (w != v)
+            {
+                lower[w] = max(lower[w], max(back[w], ecc_v - fwd[w]));
+                upper[w] = min(upper[w], back[w] + ecc_v);
+            }
+            else lower[w] = upper[w] = ecc_v;
 
-/** \brief Total number of links in the network
-*  \return number of links in the network
-*
-* Returns the total number of links initialized in the network
-*/
-template <class T, typename B>
-int DirectedCNetwork<T,B>::get_link_count() const
-{
-    return link_count;
-}
-
+            if (lower[w] == upper[w])
+            {
+                eccentricity[w] = lower[w];
+                d_low = max(d_low, lower[w]);
+                r_up = min(r_up, lower[w]);
+            }
+            else
+            {
+                candidates[j] = w;
+                j += 1;
+            }
+        }
+        candidates.resize(j);
 
+        if (not all_eccentricities)
+        {
+            //Keep only nodes that could still change the diameter or the radius
+            j = 0;
+            for (i=0; i < (int)candidates.size(); i++)
+            {
+                int w = candidates[i];
+                if (upper[w] > d_low or lower[w] < r_up)
+                {
+                    candidates[j] = w;
+                    j += 1;
+                    d_up = max(d_up, upper[w]);
+                    r_low = min(r_low, lower[w]);
+                }
+            }
+            candidates.resize(j);
+            if (d_low == d_up and r_low == r_up) break;
+        }
+    }
 
-/** \brief Get the nodes the node is pointing to
-*  \param node_index: target node
-*  \return vector containing the indices of the neighbour nodes of the target node
-*
-* Returns the a vector with the indices of the neighbours pointed by the specified node.
-*/
-template <class T, typename B>
-vector<unsigned int> DirectedCNetwork<T,B>::get_neighs_out(int node_index) const
-{
-    return neighs[node_index];
+    radius = r_up;
+    return d_low;
 }
 
 
-/** \brief Get the nodes pointing to me in the network
-*  \param node_index: target node
-*  \return vector containing the indices of the nodes that point to the target node
-*
-* Returns the a vector with the indices of the nodes that point to the specified node.
+/** \brief BFS restricted to a component, reusing the distance vector
+*  \param source: index of the origin node
+*  \param comp_label: label of the component where the search is done
+*  \param component: component label of each node
+*  \param offset, target: adjacency given by build_link_csr
+*  \param dist: workspace. Distances from previous calls are cleaned using touched.
+*  \param touched: workspace. Gets the nodes reached, in BFS order.
+*  \return eccentricity of the source inside the component
 */
-template <class T, typename B>
-vector<unsigned int> DirectedCNetwork<T,B>::get_neighs_in(int node_index) const
-{
-    return pointing_in[node_index];
-}
+template <class T, typename B>
+int DirectedCNetwork<T,B>::bounded_bfs(int source, int comp_label, const vector<int> &component, const vector<long long> &offset,
+                                       const vector<unsigned int> &target, vector<int> &dist, vector<int> &touched) const
+{
+    int r, v, w;
+    long long k;
 
-
-/** \brief Selects a neighbour of a given node
-*  \param node_index: target node
-*  \param k: neighbour to be selected
-*  \return index of the k-th neighbour of the target node
-*
-* Returns the index of the k-th neighbour of the target node. Neighbours are unsorted
-*/
-template <class T, typename B>
-int DirectedCNetwork<T,B>::get_out(int node_index, int k) const
-{
-    return neighs[node_index][k];
-}
+    for (r=0; r < (int)touched.size(); r++) dist[touched[r]] = -1;
+    touched.clear();
 
+    dist[source] = 0;
+    touched.push_back(source);
+    r = 0;
+    while (r < (int)touched.size())
+    {
+        v = touched[r];
+        r += 1;
+        for (k=offset[v]; k < offset[v+1]; k++)
+        {
+            w = target[k];
+            if (dist[w] < 0 and component[w] == comp_label)
+            {
+                dist[w] = dist[v] + 1;
+                touched.push_back(w);
+            }
+        }
+    }
 
-/** \brief Selects a node pointing to the given node
-*  \param node_index: target node
-*  \param k: node to be selected
-*  \return index of the k-th neighbour of the list of nodes pointing to me
-*
-* Returns the index of the k-th node pointing to the target node.
-*/
-template <class T, typename B>
-int DirectedCNetwork<T,B>::get_in(int node_index, int k) const
-{
-    return pointing_in[node_index][k];
+    return dist[touched.back()];
 }
 
 
-/** \brief Define a new tag for the network
-*  \param name: tag identifier
-*  \param type: can be int, double, string, or bool.
-*  \param is_for_nodes: if false, this property is assigned to links
+/** \brief Computes closeness and harmonic centrality of every node
+*  \param[out] closeness_c: closeness of each node
+*  \param[out] harmonic: harmonic centrality of each node, sum of 1/d to all other nodes
 *
-* Define a new property or tag. This will be exported to GraphML. It can
-* be used also as additional properties for network dynamics.
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::define_property(string name, string type, bool is_for_nodes)
-{
-    int n = is_for_nodes ? current_size : link_count;
-
-    if (type == "double")
-    {
-        prop_d[name] = vector<double>(n, 0.0);
-    }
-    else if (type == "int")
-    {
-        prop_i[name] = vector<int>(n, 0);
-    }
-    else if (type == "bool")
-    {
-        prop_b[name] = vector<bool>(n, false);
-    }
-    else if (type == "string")
-    {
-        prop_s[name] = vector<string>(n, "");
-    }
-    return;
-}
+* Runs a BFS from each node in parallel, reusing the workspace of each thread. Distances go from the node following
+* the links. For a node reaching r nodes (itself included) at total distance S, closeness is (r-1)/S * (r-1)/(N-1),
+* which is the usual definition scaled as proposed by Wasserman and Faust so disconnected networks are handled.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::closeness(vector<double> &closeness_c, vector<double> &harmonic) const
+{
+    int i;
 
+    vector<long long> offset;
+    vector<unsigned int> target;
+    vector<int> link;
 
-/** \brief Set the value of an existing property
-*  \param name: tag identifier
-*  \param index: index or node or link where it has to be stored
-*  \param value: the new value
-*
-* Set a value for the property "name" in the node or link index. Note that
-* user must take care of manually checking index bounds.
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::set_value(string name, int index, double value)
-{
-    prop_d[name][index] = value;
-}
+    build_link_csr(offset, target, link, false);
 
-/** \brief Set the value of an existing property
-*  \param name: tag identifier
-*  \param index: index or node or link where it has to be stored
-*  \param value: the new value
-*
-* Set a value for the property "name" in the node or link index. Note that
-* user must take care of manually checking index bounds.
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::set_value(string name, int index, int value)
-{
-    prop_i[name][index] = value;
-}
+    closeness_c = vector<double>(current_size, 0.0);
+    harmonic = vector<double>(current_size, 0.0);
 
+    #pragma omp parallel
+    {
+        vector<int> dist(current_size, -1);
+        vector<int> queue;
 
-/** \brief Set the value of an existing property
-*  \param name: tag identifier
-*  \param index: index or node or link where it has to be stored
-*  \param value: the new value
-*
-* Set a value for the property "name" in the node or link index. Note that
-* user must take care of manually checking index bounds.
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::set_value(string name, int index, bool value)
-{
-    prop_b[name][index] = value;
+        #pragma omp for schedule(dynamic, 16)
+        for (i=0; i < current_size; i++)
+        {
+            int r, v, w;
+            long long k, sum = 0;
+            double h = 0.0;
+
+            queue.clear();
+            queue.push_back(i);
+            dist[i] = 0;
+            r = 0;
+            while (r < (int)queue.size())
+            {
+                v = queue[r];
+                r += 1;
+                for (k=offset[v]; k < offset[v+1]; k++)
+                {
+                    w = target[k];
+                    if (dist[w] < 0)
+                    {
+                        dist[w] = dist[v] + 1;
+                        sum += dist[w];
+                        h += 1.0 / dist[w];
+                        queue.push_back(w);
+                    }
+                }
+            }
+
+            if (sum > 0) closeness_c[i] = (queue.size() - 1.0) / sum * (queue.size() - 1.0) / (current_size - 1.0);
+            harmonic[i] = h;
+
+            for (r=0; r < (int)queue.size(); r++) dist[queue[r]] = -1;
+        }
+    }
+
+    return;
 }
 
 
-/** \brief Set the value of an existing property
-*  \param name: tag identifier
-*  \param index: index or node or link where it has to be stored
-*  \param value: the new value
+/** \brief Approximates closeness and harmonic centrality with HyperBall
+*  \param[out] closeness_c: approximate closeness of each node, as defined in closeness()
+*  \param[out] harmonic: approximate harmonic centrality of each node
+*  \param log2_registers: optional. Each counter has 2^log2_registers registers of one byte. The relative error of
+*  the counters is about 1.04/sqrt(2^log2_registers). Default: 6, that is 64 bytes per node and 13% error.
+*  \param random_seed: optional. Seed of the hash function.
+*  \return number of iterations, equal to the largest distance found plus one
 *
-* Set a value for the property "name" in the node or link index. Note that
-* user must take care of manually checking index bounds.
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::set_value(string name, int index, string value)
-{
-    prop_s[name][index] = value;
-}
+* HyperBall algorithm of Boldi and Vigna. Each node keeps a HyperLogLog counter of the ball of radius t around it.
+* At step t+1 the counter of each node is merged with the ones of the nodes it points to, taking the maximum of each
+* register. The change in the estimated size of the ball gives the number of nodes at distance t+1. Only nodes with a
+* neighbour that changed in the previous step are updated, in parallel. Uses two arrays of N * 2^log2_registers bytes.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::approx_closeness(vector<double> &closeness_c, vector<double> &harmonic, int log2_registers, unsigned int random_seed) const
+{
+    int i, t;
+    int m = 1 << log2_registers;
+    bool changed;
+    double alpha;
+
+    vector<long long> offset;
+    vector<unsigned int> target;
+    vector<int> link;
+    vector<unsigned char> current, next;
+    vector<char> modified, next_modified;
+    vector<double> ball, sum_dist;
+
+    build_link_csr(offset, target, link, false);
+
+    closeness_c = vector<double>(current_size, 0.0);
+    harmonic = vector<double>(current_size, 0.0);
+
+    if (m == 16) alpha = 0.673;
+    else if (m == 32) alpha = 0.697;
+    else if (m == 64) alpha = 0.709;
+    else alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    //Each counter starts with the node itself
+    current = vector<unsigned char>((size_t)current_size * m, 0);
+    for (i=0; i < current_size; i++)
+    {
+        unsigned long long h = rng_stream::mix(random_seed ^ rng_stream::mix(i + 0x9E3779B97F4A7C15ULL));
+        unsigned long long rest = h >> log2_registers;
+        int rho = rest == 0 ? 65 - log2_registers : __builtin_clzll(rest) - log2_registers + 1;
+        current[(size_t)i * m + (h & (m-1))] = rho;
+    }
+    next = current;
 
+    ball = vector<double>(current_size, 1.0);
+    sum_dist = vector<double>(current_size, 0.0);
+    modified = vector<char>(current_size, 1);
+    next_modified = vector<char>(current_size, 0);
 
-/** \brief Get the value of an existing property
-*  \param name: tag identifier
-*  \param index: index or node or link where it has to be stored
-*  \return value stored
-*
-* Get a value for the property "name" in the node or link index. Note that
-* user must take care of manually checking index bounds.
-*/
-template <class T, typename B>
-double DirectedCNetwork<T,B>::get_value_d(string name, int index)
-{
-    return prop_d[name][index];
-}
+    t = 0;
+    changed = current_size > 0;
+    while (changed)
+    {
+        t += 1;
+        changed = false;
 
-/** \brief Get the value of an existing property
-*  \param name: tag identifier
-*  \param index: index or node or link where it has to be stored
-*  \return value stored
-*
-* Get a value for the property "name" in the node or link index. Note that
-* user must take care of manually checking index bounds.
-*/
-template <class T, typename B>
-int DirectedCNetwork<T,B>::get_value_i(string name, int index)
-{
-    return prop_i[name][index];
-}
+        #pragma omp parallel for schedule(dynamic, 256) reduction(||:changed)
+        for (i=0; i < current_size; i++)
+        {
+            long long k;
+            int j;
+            bool any = false;
+            unsigned char *reg = &next[(size_t)i * m];
 
-/** \brief Get the value of an existing property
-*  \param name: tag identifier
-*  \param index: index or node or link where it has to be stored
-*  \return value stored
-*
-* Get a value for the property "name" in the node or link index. Note that
-* user must take care of manually checking index bounds.
-*/
-template <class T, typename B>
-bool DirectedCNetwork<T,B>::get_value_b(string name, int index)
-{
-    return prop_b[name][index];
+            for (k=offset[i]; k < offset[i+1]; k++)
+            {
+                if (not modified[target[k]]) continue;
+                const unsigned char *other = &current[(size_t)target[k] * m];
+                #pragma omp simd
+                for (j=0; j < m; j++) reg[j] = max(reg[j], other[j]);
+                any = true;
+            }
+
+            next_modified[i] = 0;
+            if (not any) continue;
+
+            //Estimate the size of the ball
+            double z = 0.0;
+            int zeros = 0;
+            for (j=0; j < m; j++)
+            {
+                z += ldexp(1.0, -reg[j]);
+                zeros += reg[j] == 0;
+            }
+            double estimate = alpha * m * m / z;
+            if (estimate <= 2.5 * m and zeros > 0) estimate = m * log(1.0 * m / zeros);
+
+            if (estimate > ball[i])
+            {
+                sum_dist[i] += t * (estimate - ball[i]);
+                harmonic[i] += (estimate - ball[i]) / t;
+                ball[i] = estimate;
+            }
+
+            if (memcmp(reg, &current[(size_t)i * m], m) != 0)
+            {
+                next_modified[i] = 1;
+                changed = true;
+            }
+        }
+
+        //Both arrays hold the same counters for nodes that did not change
+        #pragma omp parallel for schedule(static)
+        for (i=0; i < current_size; i++) if (next_modified[i]) memcpy(&current[(size_t)i * m], &next[(size_t)i * m], m);
+        swap(modified, next_modified);
+    }
+
+    for (i=0; i < current_size; i++)
+    {
+        if (sum_dist[i] > 0.0) closeness_c[i] = (ball[i] - 1.0) / sum_dist[i] * (ball[i] - 1.0) / (current_size - 1.0);
+    }
+
+    return t;
 }
 
-/** \brief Get the value of an existing property
-*  \param name: tag identifier
-*  \param index: index or node or link where it has to be stored
-*  \return value stored
-*
-* Get a value for the property "name" in the node or link index. Note that
-* user must take care of manually checking index bounds.
-*/
-template <class T, typename B>
-string DirectedCNetwork<T,B>::get_value_s(string name, int index)
-{
-    return prop_s[name][index];
-}
-
-/** \brief Export network data to GraphML, Gephi compatible format
-*  \param filename: name of the file (without extension)
-*  \param labels: optional. Tags used to name the nodes
+
+/** \brief Builds a frozen adjacency for random walks
+*  \param[out] walker: adjacency with the links going out of each node, sorted by target
+*  \param weighted: optional. If true, build alias tables so steps follow the weights of the links.
 *
-* Export the network data. Properties defined via define_property will be stored as node or link
-* properties. In addition to that, it is also possible to label directly the nodes. This will be
-* recognized as a node identifier in software like Gephi. For compatibility, MTX format is preferred
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels) const
+* Alias tables are built with Vose's method. Weights must be non-negative. See walk_adjacency for the walks.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::build_walk_adjacency(walk_adjacency &walker, bool weighted) const
+{
+    int i;
+
+    vector<int> link;
+
+    build_link_csr(walker.offset, walker.target, link, false);
+    walker.weighted = weighted;
+    walker.prob.clear();
+    walker.alias.clear();
+
+    if (weighted)
+    {
+        walker.prob = vector<float>(link.size());
+        walker.alias = vector<unsigned int>(link.size());
+    }
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i=0; i < current_size; i++)
+    {
+        long long start = walker.offset[i];
+        int k = walker.offset[i+1] - start;
+        int j;
+
+        //Sort by target, keeping the weights together
+        vector< pair<unsigned int, double> > row(k);
+        for (j=0; j < k; j++) row[j] = make_pair(walker.target[start+j], weighted ? (double)adjm.m[link[start+j]].value : 1.0);
+        sort(row.begin(), row.end());
+        for (j=0; j < k; j++) walker.target[start+j] = row[j].first;
+
+        if (not weighted or k == 0) continue;
+
+        //Vose's alias method
+        double total = 0.0;
+        for (j=0; j < k; j++) total += row[j].second;
+
+        vector<double> scaled(k);
+        vector<int> small, large;
+        for (j=0; j < k; j++)
+        {
+            scaled[j] = total > 0.0 ? row[j].second * k / total : 1.0;
+            if (scaled[j] < 1.0) small.push_back(j);
+            else large.push_back(j);
+        }
+        while (small.size() > 0 and large.size() > 0)
+        {
+            int l = small.back();
+            int g = large.back();
+            small.pop_back();
+            walker.prob[start+l] = scaled[l];
+            walker.alias[start+l] = g;
+            scaled[g] = (scaled[g] + scaled[l]) - 1.0;
+            if (scaled[g] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(g);
+            }
+        }
+        //Remaining ones are full, up to rounding
+        for (j=0; j < (int)large.size(); j++)
+        {
+            walker.prob[start+large[j]] = 1.0;
+            walker.alias[start+large[j]] = large[j];
+        }
+        for (j=0; j < (int)small.size(); j++)
+        {
+            walker.prob[start+small[j]] = 1.0;
+            walker.alias[start+small[j]] = small[j];
+        }
+    }
+
+    return;
+}
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Computes the percolation curve of the network with the Newman-Ziff algorithm
+*  \param[out] largest: element j is the size of the largest cluster, divided by the number of nodes, when j nodes (or links) are present
+*  \param[out] susceptibility: element j is the sum of the squared sizes of all clusters but the largest one, divided by the number of nodes
+*  \param[out] second: element j is the size of the second largest cluster, divided by the number of nodes
+*  \param site: optional. If true (default), nodes are removed. If false, links are removed and all nodes stay.
+*  \param order: optional. Order in which nodes (or links) are removed, for example given by attack_order. If empty, the order is random.
+*  \param random_seed: optional. Seed used for the random order.
+*
+* Elements are added in the reverse order of removal, joining clusters with a weighted union-find, so the whole curve
+* costs about O(N + E). All the curves have one more element than nodes (or links), and element j corresponds to the
+* network after removing the first N-j elements of the order. Directed links are treated as undirected.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::percolation(vector<double> &largest, vector<double> &susceptibility, vector<double> &second, bool site,
+                                        const vector<int> &order, unsigned int random_seed) const
+{
+    int i, j;
+    int n_elements = site ? current_size : link_count;
+    int big, second_big;
+    double sum_squares;
+
+    vector<long long> offset;
+    vector<unsigned int> adj;
+    vector<int> sequence(order);
+    vector<int> parent(current_size), size(current_size, 1);
+    vector<int> size_count(current_size+1, 0); //Number of clusters of each size
+    vector<bool> present(current_size, not site);
+
+    largest = vector<double>(n_elements+1, 0.0);
+    susceptibility = vector<double>(n_elements+1, 0.0);
+    second = vector<double>(n_elements+1, 0.0);
+    if (current_size == 0) return;
+
+    if (sequence.size() == 0)
+    {
+        sequence = vector<int>(n_elements);
+        for (i=0; i < n_elements; i++) sequence[i] = i;
+        rng_stream gen(random_seed);
+        shuffle(sequence.begin(), sequence.end(), gen);
+    }
+
+    if (site) build_undirected_csr(offset, adj);
+    for (i=0; i < current_size; i++) parent[i] = i;
+
+    //Root of the cluster, with path halving
+    auto find_root = [&parent](int x) -> int
+    {
+        while (parent[x] != x)
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+
+    //Starting state: no nodes, or only isolated nodes
+    big = site ? 0 : 1;
+    second_big = site ? 0 : (current_size > 1 ? 1 : 0);
+    sum_squares = site ? 0.0 : current_size;
+    if (not site) size_count[1] = current_size;
+
+    //Joins two clusters, updating the statistics
+    auto join = [&](int a, int b)
+    {
+        a = find_root(a);
+        b = find_root(b);
+        if (a == b) return;
+        if (size[a] < size[b]) swap(a, b);
+
+        int previous_big = big;
+        int previous_a = size[a];
+
+        size_count[size[a]] -= 1;
+        size_count[size[b]] -= 1;
+        sum_squares += 2.0 * size[a] * size[b];
+        parent[b] = a;
+        size[a] += size[b];
+        size_count[size[a]] += 1;
+
+        //Second largest cluster, without scanning all sizes after each join
+        big = max(big, size[a]);
+        if (size_count[big] > 1) second_big = big;
+        else if (size[a] < big) second_big = max(second_big, size[a]);
+        else if (previous_a < previous_big) second_big = previous_big; //a just overtook the largest one
+        else
+        {
+            //a was already the largest: the second one is still there, unless b was it
+            while (second_big > 0 and size_count[second_big] == 0) second_big -= 1;
+        }
+    };
+
+    for (j=0; j <= n_elements; j++)
+    {
+        if (j > 0)
+        {
+            int e = sequence[n_elements - j]; //Add in reverse order of removal
+            if (site)
+            {
+                present[e] = true;
+                size_count[1] += 1;
+                sum_squares += 1.0;
+                big = max(big, 1);
+                if (size_count[big] > 1) second_big = big;
+                else if (big > 1) second_big = max(second_big, 1);
+                for (long long k=offset[e]; k < offset[e+1]; k++) if (present[adj[k]]) join(e, adj[k]);
+            }
+            else join(adjm.m[e].x, adjm.m[e].y);
+        }
+
+        largest[j] = 1.0 * big / current_size;
+        second[j] = 1.0 * second_big / current_size;
+        susceptibility[j] = (sum_squares - 1.0 * big * big) / current_size;
+    }
+
+    return;
+}
+
+
+/** \brief Gives the order of removal for a targeted attack
+*  \param[out] order: elements sorted in the order they should be removed
+*  \param score: optional. If given, elements are removed from largest to smallest score. It can be the betweenness of
+*  nodes or links, or any other centrality. The size of score decides if the order is for nodes or links.
+*  \param adaptive: optional. Used only without score. If true, the node with largest degree among the remaining ones is
+*  removed each time. If false (default), nodes are sorted by their initial degree.
+*
+* The order can be passed to percolation. Adaptive degree uses buckets of degree and costs O(N + E).
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::attack_order(vector<int> &order, const vector<double> &score, bool adaptive) const
+{
+    int i, k;
+    int max_k;
+
+    vector<long long> offset;
+    vector<unsigned int> adj;
+    vector<int> degree_now, bucket_start, position, sorted_nodes;
+
+    order.clear();
+
+    if (score.size() > 0)
+    {
+        order = vector<int>(score.size());
+        for (i=0; i < (int)score.size(); i++) order[i] = i;
+        stable_sort(order.begin(), order.end(), [&score](int a, int b) {return score[a] > score[b];});
+        return;
+    }
+
+    build_undirected_csr(offset, adj);
+
+    degree_now = vector<int>(current_size);
+    max_k = 0;
+    for (i=0; i < current_size; i++)
+    {
+        degree_now[i] = offset[i+1] - offset[i];
+        max_k = max(max_k, degree_now[i]);
+    }
+
+    //Sort nodes by degree with buckets, keeping the position of each node
+    bucket_start = vector<int>(max_k+2, 0);
+    for (i=0; i < current_size; i++) bucket_start[degree_now[i]+1] += 1;
+    for (k=0; k <= max_k; k++) bucket_start[k+1] += bucket_start[k];
+    sorted_nodes = vector<int>(current_size);
+    position = vector<int>(current_size);
+    vector<int> fill(bucket_start.begin(), bucket_start.end()-1);
+    for (i=0; i < current_size; i++)
+    {
+        position[i] = fill[degree_now[i]];
+        sorted_nodes[position[i]] = i;
+        fill[degree_now[i]] += 1;
+    }
+
+    if (not adaptive)
+    {
+        order = vector<int>(sorted_nodes.rbegin(), sorted_nodes.rend());
+        return;
+    }
+
+    //Take always the last node of the array, which has largest degree, and move down its neighbours
+    vector<bool> removed(current_size, false);
+    for (i=current_size-1; i >= 0; i--)
+    {
+        int v = sorted_nodes[i];
+        removed[v] = true;
+        order.push_back(v);
+        bucket_start[degree_now[v]+1] -= 1; //v is out of the array, which now ends at i
+
+        for (long long e=offset[v]; e < offset[v+1]; e++)
+        {
+            int w = adj[e];
+            if (removed[w]) continue;
+
+            //Swap w with the first node of its bucket, and move the bucket boundary
+            k = degree_now[w];
+            int first = bucket_start[k];
+            int u = sorted_nodes[first];
+            swap(sorted_nodes[first], sorted_nodes[position[w]]);
+            position[u] = position[w];
+            position[w] = first;
+            bucket_start[k] += 1;
+            degree_now[w] -= 1;
+        }
+    }
+
+    return;
+}
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Builds a compact adjacency with the index of each link
+*  \param[out] offset: links of node j are stored between offset[j] and offset[j+1]
+*  \param[out] target: node at the other end of each link
+*  \param[out] link: index of each link, to get its weight from adjm or its properties
+*  \param reverse: if true, store the links pointing to each node instead of the ones going out
+*
+* Creates a CSR (compressed sparse row) snapshot of the network from adjm, keeping the link indices. For undirected
+* networks every link is stored at both ends, and reverse has no effect.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::build_link_csr(vector<long long> &offset, vector<unsigned int> &target, vector<int> &link, bool reverse) const
+{
+    int i;
+    unsigned int from, to;
+
+    vector<long long> pos;
+
+    offset = vector<long long>(current_size+1, 0);
+
+    //Count the links of each node
+    for (i=0; i < link_count; i++)
+    {
+        from = reverse ? adjm.m[i].y : adjm.m[i].x;
+        to = reverse ? adjm.m[i].x : adjm.m[i].y;
+        offset[from+1] += 1;
+        if (not directed and from != to) offset[to+1] += 1;
+    }
+    for (i=0; i < current_size; i++) offset[i+1] += offset[i];
+
+    //Then fill them
+    target = vector<unsigned int>(offset[current_size]);
+    link = vector<int>(offset[current_size]);
+    pos = vector<long long>(offset.begin(), offset.end()-1);
+    for (i=0; i < link_count; i++)
+    {
+        from = reverse ? adjm.m[i].y : adjm.m[i].x;
+        to = reverse ? adjm.m[i].x : adjm.m[i].y;
+        target[pos[from]] = to;
+        link[pos[from]] = i;
+        pos[from] += 1;
+        if (not directed and from != to)
+        {
+            target[pos[to]] = from;
+            link[pos[to]] = i;
+            pos[to] += 1;
+        }
+    }
+
+    return;
+}
+
+
+/** \brief Computes distances and number of shortest paths from a source
+*  \param source: origin node
+*  \param stop_at: if non-negative, stop as soon as the distance to this node is final
+*  \param weighted: if true use Dijkstra with the link weights, if not use BFS
+*  \param offset, target, link: adjacency given by build_link_csr
+*  \param weight: weight of each link index. Only used if weighted is true.
+*  \param[out] dist: distance to each node. Must be filled with -1 on input; touched entries are overwritten.
+*  \param[out] sigma: number of shortest paths to each node. Must be filled with 0 on input.
+*  \param[out] order: nodes whose distance is final, in non-decreasing distance.
+*  \param[out] touched: all the nodes whose dist or sigma were modified, to clean them afterwards.
+*
+* Core of the Brandes algorithm. Weights must be positive.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::count_shortest_paths(int source, int stop_at, bool weighted, const vector<long long> &offset, const vector<unsigned int> &target,
+                                                 const vector<int> &link, const vector<double> &weight, vector<double> &dist, vector<double> &sigma,
+                                                 vector<int> &order, vector<int> &touched) const
+{
+    long long k;
+    int v, w;
+    double d;
+
+    order.clear();
+    touched.clear();
+
+    dist[source] = 0.0;
+    sigma[source] = 1.0;
+    touched.push_back(source);
+
+    if (not weighted)
+    {
+        //BFS, using touched as the queue
+        int r = 0;
+        while (r < (int)touched.size())
+        {
+            v = touched[r];
+            r += 1;
+            order.push_back(v);
+            if (v == stop_at) return;
+
+            for (k=offset[v]; k < offset[v+1]; k++)
+            {
+                w = target[k];
+                if (dist[w] < 0.0)
+                {
+                    dist[w] = dist[v] + 1.0;
+                    touched.push_back(w);
+                }
+                if (dist[w] == dist[v] + 1.0) sigma[w] += sigma[v];
+            }
+        }
+    }
+    else
+    {
+        //Dijkstra with a binary heap and lazy deletion
+        priority_queue< pair<double,int>, vector< pair<double,int> >, greater< pair<double,int> > > heap;
+
+        heap.push(make_pair(0.0, source));
+        while (heap.size() > 0)
+        {
+            d = heap.top().first;
+            v = heap.top().second;
+            heap.pop();
+            if (d > dist[v]) continue; //Old entry, the node was already settled with a shorter distance
+
+            order.push_back(v);
+            if (v == stop_at) return;
+
+            for (k=offset[v]; k < offset[v+1]; k++)
+            {
+                w = target[k];
+                d = dist[v] + weight[link[k]];
+                if (dist[w] < 0.0 or d < dist[w] * (1.0 - 1e-12))
+                {
+                    if (dist[w] < 0.0) touched.push_back(w);
+                    dist[w] = d;
+                    sigma[w] = sigma[v];
+                    heap.push(make_pair(d, w));
+                }
+                else if (d <= dist[w] * (1.0 + 1e-12)) sigma[w] += sigma[v];
+            }
+        }
+    }
+
+    return;
+}
+
+
+/** \brief Computes the betweenness centrality of nodes and links
+*  \param[out] node_bc: element j is the betweenness of node j
+*  \param[out] link_bc: element j is the betweenness of link j, with the same indices as adjm
+*  \param weighted: optional. If true, shortest paths use the link weights, which must be positive.
+*  \param normalized: optional. If true, node values are divided by the number of pairs of other nodes.
+*
+* Brandes' algorithm. Every node is used as a source, and sources are distributed between threads when compiled
+* with OpenMP, each one with its own accumulators. For undirected networks each pair of nodes is counted once.
+* Cost is O(NE) for unweighted networks, so for large networks approx_betweenness is preferred.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::betweenness(vector<double> &node_bc, vector<double> &link_bc, bool weighted, bool normalized) const
+{
+    int i;
+    double factor;
+
+    vector<long long> offset;
+    vector<unsigned int> target;
+    vector<int> link;
+    vector<double> weight(link_count, 1.0);
+
+    build_link_csr(offset, target, link, false);
+    if (weighted) for (i=0; i < link_count; i++) weight[i] = adjm.m[i].value;
+
+    node_bc = vector<double>(current_size, 0.0);
+    link_bc = vector<double>(link_count, 0.0);
+
+    #pragma omp parallel
+    {
+        //Workspace and accumulators of each thread
+        vector<double> dist(current_size, -1.0), sigma(current_size, 0.0), delta(current_size, 0.0);
+        vector<double> local_node(current_size, 0.0), local_link(link_count, 0.0);
+        vector<int> order, touched;
+
+        #pragma omp for schedule(dynamic, 16)
+        for (i=0; i < current_size; i++)
+        {
+            count_shortest_paths(i, -1, weighted, offset, target, link, weight, dist, sigma, order, touched);
+
+            //Accumulate dependencies from the farthest nodes, looking at their successors
+            for (int j=order.size()-1; j >= 0; j--)
+            {
+                int v = order[j];
+                for (long long k=offset[v]; k < offset[v+1]; k++)
+                {
+                    int w = target[k];
+                    double d = dist[v] + weight[link[k]];
+                    bool is_successor = weighted ? (dist[w] > 0.0 and abs(d - dist[w]) <= 1e-12 * dist[w]) : dist[w] == d;
+                    if (is_successor)
+                    {
+                        double c = sigma[v] / sigma[w] * (1.0 + delta[w]);
+                        delta[v] += c;
+                        local_link[link[k]] += c;
+                    }
+                }
+                if (v != i) local_node[v] += delta[v];
+            }
+
+            //Clean the workspace
+            for (int j=0; j < (int)touched.size(); j++)
+            {
+                dist[touched[j]] = -1.0;
+                sigma[touched[j]] = 0.0;
+                delta[touched[j]] = 0.0;
+            }
+        }
+
+        #pragma omp critical
+        {
+            for (int j=0; j < current_size; j++) node_bc[j] += local_node[j];
+            for (int j=0; j < link_count; j++) link_bc[j] += local_link[j];
+        }
+    }
+
+    //In undirected networks each path has been seen from both ends
+    if (not directed)
+    {
+        for (i=0; i < current_size; i++) node_bc[i] *= 0.5;
+        for (i=0; i < link_count; i++) link_bc[i] *= 0.5;
+    }
+
+    if (normalized and current_size > 2)
+    {
+        factor = (current_size - 1.0) * (current_size - 2.0);
+        if (not directed) factor *= 0.5;
+        for (i=0; i < current_size; i++) node_bc[i] /= factor;
+    }
+
+    return;
+}
+
+
+/** \brief Estimates the betweenness centrality of nodes and links by sampling
+*  \param[out] node_bc: element j is the estimated betweenness of node j
+*  \param[out] link_bc: element j is the estimated betweenness of link j, with the same indices as adjm
+*  \param epsilon: maximum error allowed, relative to the number of pairs of nodes
+*  \param delta: optional. Probability that some node has an error larger than epsilon. Default: 0.1
+*  \param weighted: optional. If true, shortest paths use the link weights, which must be positive.
+*  \param normalized: optional. If true, node values are divided by the number of pairs of other nodes.
+*  \param random_seed: optional, default 123456789.
+*  \return number of sampled paths
+*
+* Algorithm of Riondato and Kornaropoulos: random pairs of nodes are selected, and a shortest path between them is
+* sampled uniformly. The number of samples is chosen from epsilon, delta and a bound of the vertex diameter, so all the
+* estimations are within the error with probability 1-delta. Each search stops as soon as the target is found.
+* Results have the same scale as betweenness, and do not depend on the number of threads.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::approx_betweenness(vector<double> &node_bc, vector<double> &link_bc, double epsilon, double delta, bool weighted, bool normalized, unsigned int random_seed) const
+{
+    int i;
+    int n_samples;
+    double vertex_diameter;
+    double pairs;
+
+    vector<long long> offset, in_offset;
+    vector<unsigned int> target, in_target;
+    vector<int> link, in_link;
+    vector<double> weight(link_count, 1.0);
+
+    node_bc = vector<double>(current_size, 0.0);
+    link_bc = vector<double>(link_count, 0.0);
+    if (current_size < 3) return 0;
+
+    build_link_csr(offset, target, link, false);
+    build_link_csr(in_offset, in_target, in_link, true);
+    if (weighted) for (i=0; i < link_count; i++) weight[i] = adjm.m[i].value;
+
+    //Bound of the vertex diameter. For unweighted undirected networks, twice the eccentricity of any node plus one,
+    //taking the largest bound of all the connected components
+    vertex_diameter = current_size;
+    if (not directed and not weighted)
+    {
+        vector<double> dist(current_size, -1.0), sigma(current_size, 0.0);
+        vector<int> order, touched;
+        vertex_diameter = 1.0;
+        for (i=0; i < current_size; i++)
+        {
+            if (dist[i] >= 0.0) continue; //Already seen from another node of its component
+            count_shortest_paths(i, -1, false, offset, target, link, weight, dist, sigma, order, touched);
+            vertex_diameter = max(vertex_diameter, 2.0 * dist[order.back()] + 1.0);
+        }
+        vertex_diameter = min(vertex_diameter, 1.0 * current_size);
+    }
+
+    n_samples = ceil(0.5 / (epsilon * epsilon) * (floor(log2(max(vertex_diameter - 2.0, 1.0))) + 1.0 + log(1.0 / delta)));
+
+    #pragma omp parallel
+    {
+        vector<double> dist(current_size, -1.0), sigma(current_size, 0.0);
+        vector<double> local_node(current_size, 0.0), local_link(link_count, 0.0);
+        vector<int> order, touched;
+
+        #pragma omp for schedule(dynamic, 64)
+        for (i=0; i < n_samples; i++)
+        {
+            rng_stream gen(random_seed, i);
+            int s = gen.below(current_size);
+            int t = gen.below(current_size - 1);
+            if (t >= s) t += 1;
+
+            count_shortest_paths(s, t, weighted, offset, target, link, weight, dist, sigma, order, touched);
+
+            //Go back from t, choosing each predecessor with probability proportional to its number of paths
+            if (dist[t] >= 0.0)
+            {
+                int v = t;
+                while (v != s)
+                {
+                    double r = gen.uniform() * sigma[v];
+                    double acc = 0.0;
+                    long long chosen = -1;
+                    for (long long k=in_offset[v]; k < in_offset[v+1] and chosen < 0; k++)
+                    {
+                        int u = in_target[k];
+                        double d = dist[u] + weight[in_link[k]];
+                        bool is_pred = dist[u] >= 0.0 and (weighted ? abs(d - dist[v]) <= 1e-12 * dist[v] : d == dist[v]);
+                        if (is_pred)
+                        {
+                            acc += sigma[u];
+                            if (r < acc) chosen = k;
+                        }
+                    }
+                    if (chosen < 0) break; //Only possible by rounding errors
+
+                    local_link[in_link[chosen]] += 1.0;
+                    v = in_target[chosen];
+                    if (v != s) local_node[v] += 1.0;
+                }
+            }
+
+            for (int j=0; j < (int)touched.size(); j++)
+            {
+                dist[touched[j]] = -1.0;
+                sigma[touched[j]] = 0.0;
+            }
+        }
+
+        #pragma omp critical
+        {
+            for (int j=0; j < current_size; j++) node_bc[j] += local_node[j];
+            for (int j=0; j < link_count; j++) link_bc[j] += local_link[j];
+        }
+    }
+
+    //Scale to the number of pairs, so values are comparable with the exact betweenness
+    pairs = directed ? current_size * (current_size - 1.0) : 0.5 * current_size * (current_size - 1.0);
+    for (i=0; i < current_size; i++) node_bc[i] *= pairs / n_samples;
+    for (i=0; i < link_count; i++) link_bc[i] *= pairs / n_samples;
+
+    if (normalized)
+    {
+        double factor = (current_size - 1.0) * (current_size - 2.0);
+        if (not directed) factor *= 0.5;
+        for (i=0; i < current_size; i++) node_bc[i] /= factor;
+    }
+
+    return n_samples;
+}
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Finds the strongly connected components of the network
+*  \param[out] component: element j is the label of the strongly connected component of node j
+*  \param parallel: optional. If true, use the coloring (forward-backward) algorithm, which runs in parallel when compiled with OpenMP.
+*  \return number of strongly connected components
+*
+* Labels every node with its strongly connected component, following links in their direction. By default it uses
+* an iterative version of Pearce's algorithm, which needs no recursion and only one integer per node. Labels are then
+* given in reverse topological order: every link between two different components goes from a higher to a lower label.
+* The parallel version is preferred for very large graphs, but its labels are not topologically sorted.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::strong_components(vector<int> &component, bool parallel) const
+{
+    if (parallel) return strong_components_coloring(component);
+    else return strong_components_pearce(component);
+}
+
+
+/** \brief Iterative Pearce's algorithm for strongly connected components
+*  \param[out] component: element j is the label of the strongly connected component of node j
+*  \return number of strongly connected components
+*
+* Implementation of Pearce's algorithm (PEA_FIND_SCC2), with the recursion replaced by an explicit stack.
+* The rindex of a node is its DFS index while it is being visited, and it is overwritten by a label counting down
+* from current_size-1 once its component is complete.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::strong_components_pearce(vector<int> &component) const
+{
+    int i;
+    int v,w;
+    int index; //Next DFS index to assign
+    int c; //Next component label, counting down
+
+    vector<int> rindex(current_size, 0); //0 means not visited yet
+    vector<bool> root(current_size, false); //True while node can still be the root of a component
+    vector<int> edge_pos(current_size, 0); //Next out-link to explore for every node
+    vector<int> call_stack; //Replaces the recursion
+    vector<int> scc_stack; //Visited nodes still waiting for their component
+
+    index = 1;
+    c = current_size - 1;
+    for (i=0; i < current_size; i++)
+    {
+        if (rindex[i] == 0)
+        {
+            //Start a new DFS from i
+            rindex[i] = index;
+            index += 1;
+            root[i] = true;
+            call_stack.push_back(i);
+
+            while (call_stack.size() > 0)
+            {
+                v = call_stack.back();
+                if (edge_pos[v] < (int)neighs[v].size())
+                {
+                    w = neighs[v][edge_pos[v]];
+                    if (rindex[w] == 0)
+                    {
+                        //Descend into w. The edge of v is advanced when w finishes
+                        rindex[w] = index;
+                        index += 1;
+                        root[w] = true;
+                        call_stack.push_back(w);
+                    }
+                    else
+                    {
+                        //Already visited. Finished components have large rindex, so they never update v
+                        if (rindex[w] < rindex[v])
+                        {
+                            rindex[v] = rindex[w];
+                            root[v] = false;
+                        }
+                        edge_pos[v] += 1;
+                    }
+                }
+                else
+                {
+                    //All the links of v have been explored
+                    call_stack.pop_back();
+                    if (root[v])
+                    {
+                        //v is the root of a component: everything above it in the stack belongs to it
+                        index -= 1;
+                        while (scc_stack.size() > 0 and rindex[v] <= rindex[scc_stack.back()])
+                        {
+                            w = scc_stack.back();
+                            scc_stack.pop_back();
+                            rindex[w] = c;
+                            index -= 1;
+                        }
+                        rindex[v] = c;
+                        c -= 1;
+                    }
+                    else scc_stack.push_back(v);
+
+                    //Return to the parent, as the recursive version would do
+                    if (call_stack.size() > 0)
+                    {
+                        w = call_stack.back();
+                        if (rindex[v] < rindex[w])
+                        {
+                            rindex[w] = rindex[v];
+                            root[w] = false;
+                        }
+                        edge_pos[w] += 1;
+                    }
+                }
+            }
+        }
+    }
+
+    //Translate labels so the first completed component is 0
+    component = vector<int>(current_size);
+    for (i=0; i < current_size; i++) component[i] = current_size - 1 - rindex[i];
+
+    return current_size - 1 - c;
+}
+
+
+/** \brief Parallel coloring algorithm for strongly connected components
+*  \param[out] component: element j is the label of the strongly connected component of node j
+*  \return number of strongly connected components
+*
+* Forward-backward coloring algorithm (Orzan). Nodes with no active in- or out- links are trimmed as single components.
+* Then the largest node index is propagated forward as a color, and each node that keeps its own color is the root of a component,
+* recovered with a backward BFS restricted to its color. Propagation and backward searches run in parallel with OpenMP.
+* Trimming keeps a counter of the active in- and out- links of each node, so long chains are trimmed in O(N+E).
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::strong_components_coloring(vector<int> &component) const
+{
+    int i;
+    int n_comp; //Number of components found so far
+    bool changed;
+
+    //For undirected networks neighs already contains both directions
+    const vector< vector<unsigned int> > &in_links = directed ? pointing_in : neighs;
+
+    vector<int> active; //Nodes without a component yet
+    vector<int> roots; //Roots of the colors in this round
+    vector<int> color(current_size), next_color(current_size);
+    vector<int> live_in(current_size), live_out(current_size); //Links with nodes without a component, without self-loops
+    vector<int> frontier, next, labeled;
+
+    //Removes labeled nodes from the counters of their neighbours. Nodes left without in- or out- links go to zero_list
+    auto release = [&](const vector<int> &removed, vector<int> &zero_list)
+    {
+        zero_list.clear();
+
+        #pragma omp parallel
+        {
+            vector<int> local;
+
+            #pragma omp for schedule(dynamic, 256)
+            for (int r=0; r < (int)removed.size(); r++)
+            {
+                int v = removed[r];
+                int left;
+                for (int j=0; j < (int)neighs[v].size(); j++)
+                {
+                    int u = neighs[v][j];
+                    if (u != v and component[u] < 0)
+                    {
+                        #pragma omp atomic capture
+                        left = --live_in[u];
+                        if (left == 0) local.push_back(u);
+                    }
+                }
+                for (int j=0; j < (int)in_links[v].size(); j++)
+                {
+                    int u = in_links[v][j];
+                    if (u != v and component[u] < 0)
+                    {
+                        #pragma omp atomic capture
+                        left = --live_out[u];
+                        if (left == 0) local.push_back(u);
+                    }
+                }
+            }
+
+            #pragma omp critical
+            zero_list.insert(zero_list.end(), local.begin(), local.end());
+        }
+
+        //A node can lose both directions at once. Sorting also makes the labels independent of the threads
+        sort(zero_list.begin(), zero_list.end());
+        zero_list.erase(unique(zero_list.begin(), zero_list.end()), zero_list.end());
+    };
+
+    component = vector<int>(current_size, -1);
+    active = vector<int>(current_size);
+    for (i=0; i < current_size; i++) active[i] = i;
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i=0; i < current_size; i++)
+    {
+        live_out[i] = neighs[i].size() - count(neighs[i].begin(), neighs[i].end(), (unsigned int)i);
+        live_in[i] = in_links[i].size() - count(in_links[i].begin(), in_links[i].end(), (unsigned int)i);
+    }
+    for (i=0; i < current_size; i++) if (live_in[i] == 0 or live_out[i] == 0) frontier.push_back(i);
+
+    n_comp = 0;
+    while (active.size() > 0)
+    {
+        //Trim nodes that cannot be in a cycle: they are components by themselves. Their removal can leave
+        //their neighbours without in- or out- links, which are trimmed next
+        while (frontier.size() > 0)
+        {
+            for (i=0; i < (int)frontier.size(); i++)
+            {
+                component[frontier[i]] = n_comp;
+                n_comp += 1;
+            }
+            release(frontier, next);
+            swap(frontier, next);
+        }
+        active.erase(remove_if(active.begin(), active.end(), [&component](int v) {return component[v] >= 0;}), active.end());
+
+        if (active.size() == 0) break;
+
+    //Propagate forward the largest node index. Nodes pull the color from their predecessors
+        for (i=0; i < (int)active.size(); i++) color[active[i]] = active[i];
+        do
+        {
+            changed = false;
+            #pragma omp parallel for schedule(dynamic, 256) reduction(||:changed)
+            for (i=0; i < (int)active.size(); i++)
+            {
+                int v = active[i];
+                int c = color[v];
+                for (int j=0; j < (int)in_links[v].size(); j++)
+                {
+                    int u = in_links[v][j];
+                    if (component[u] < 0 and color[u] > c) c = color[u];
+                }
+                next_color[v] = c;
+                changed = changed or c != color[v];
+            }
+            #pragma omp parallel for
+            for (i=0; i < (int)active.size(); i++) color[active[i]] = next_color[active[i]];
+        }
+        while (changed);
+
+        //Nodes that kept their own color are roots. Each root gives a component
+        roots = vector<int>();
+        for (i=0; i < (int)active.size(); i++) if (color[active[i]] == active[i]) roots.push_back(active[i]);
+
+        //Backward BFS from every root, only inside its color. Colors are disjoint, so searches are independent
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (i=0; i < (int)roots.size(); i++)
+        {
+            int r = roots[i];
+            int label = n_comp + i;
+            vector<int> queue(1, r);
+            int read = 0;
+
+            component[r] = label;
+            while (read < (int)queue.size())
+            {
+                int v = queue[read];
+                read += 1;
+                for (int j=0; j < (int)in_links[v].size(); j++)
+                {
+                    int u = in_links[v][j];
+                    if (color[u] == r and component[u] < 0)
+                    {
+                        component[u] = label;
+                        queue.push_back(u);
+                    }
+                }
+            }
+        }
+        n_comp += roots.size();
+
+        //Nodes found in this round leave the counters of the rest, which may be trimmed now
+        labeled.clear();
+        for (i=0; i < (int)active.size(); i++) if (component[active[i]] >= 0) labeled.push_back(active[i]);
+        release(labeled, frontier);
+
+        active.erase(remove_if(active.begin(), active.end(), [&component](int v) {return component[v] >= 0;}), active.end());
+    }
+
+    return n_comp;
+}
+
+
+/** \brief Finds the weakly connected components of the network
+*  \param[out] component: element j is the label of the weakly connected component of node j
+*  \return number of weakly connected components
+*
+* Labels every node with its component, ignoring the direction of the links. It uses a BFS over both the nodes
+* pointed by and pointing to each node, so it is linear in the size of the network.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::weak_components(vector<int> &component) const
+{
+    int i,j;
+    int r, v, w;
+    int n_comp;
+
+    vector<int> queue(current_size);
+
+    component = vector<int>(current_size, -1);
+
+    n_comp = 0;
+    for (i=0; i < current_size; i++)
+    {
+        if (component[i] < 0)
+        {
+            //BFS from i, using the queue as a list of found nodes
+            component[i] = n_comp;
+            queue[0] = i;
+            r = 0;
+            w = 1;
+            while (r < w)
+            {
+                v = queue[r];
+                r += 1;
+                for (j=0; j < (int)neighs[v].size(); j++)
+                {
+                    if (component[neighs[v][j]] < 0)
+                    {
+                        component[neighs[v][j]] = n_comp;
+                        queue[w] = neighs[v][j];
+                        w += 1;
+                    }
+                }
+                //Undirected networks store everything in neighs
+                if (v < (int)pointing_in.size())
+                {
+                    for (j=0; j < (int)pointing_in[v].size(); j++)
+                    {
+                        if (component[pointing_in[v][j]] < 0)
+                        {
+                            component[pointing_in[v][j]] = n_comp;
+                            queue[w] = pointing_in[v][j];
+                            w += 1;
+                        }
+                    }
+                }
+            }
+            n_comp += 1;
+        }
+    }
+
+    return n_comp;
+}
+
+
+/** \brief Builds the condensation DAG of the network
+*  \param component: component labels of the nodes, as given by strong_components
+*  \param n_components: number of components
+*  \param[out] dag_links: list of (origin, target) pairs of components, without repetitions
+*
+* Each strongly connected component is collapsed into a single node. Two components are linked if there is
+* at least a link between their nodes. Links are sorted by origin component.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::condensation(const vector<int> &component, int n_components, vector< pair<int,int> > &dag_links) const
+{
+    int i,j,k;
+    int v,c,d;
+
+    vector<int> start(n_components+1, 0); //Where each component begins in members
+    vector<int> members(current_size); //Nodes sorted by component
+    vector<int> last_seen(n_components, -1); //Last origin component that linked to this one
+
+    dag_links = vector< pair<int,int> >();
+
+    //Counting sort of the nodes by component
+    for (i=0; i < current_size; i++) start[component[i]+1] += 1;
+    for (i=0; i < n_components; i++) start[i+1] += start[i];
+    vector<int> pos(start.begin(), start.end()-1);
+    for (i=0; i < current_size; i++)
+    {
+        members[pos[component[i]]] = i;
+        pos[component[i]] += 1;
+    }
+
+    //Now check the links of each component only once per target
+    for (c=0; c < n_components; c++)
+    {
+        for (k=start[c]; k < start[c+1]; k++)
+        {
+            v = members[k];
+            for (j=0; j < (int)neighs[v].size(); j++)
+            {
+                d = component[neighs[v][j]];
+                if (d != c and last_seen[d] != c)
+                {
+                    last_seen[d] = c;
+                    dag_links.push_back(make_pair(c, d));
+                }
+            }
+        }
+    }
+
+    return;
+}
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Builds a compact, undirected copy of the adjacency
+*  \param[out] offset: neighbours of node j are stored in adj between offset[j] and offset[j+1]
+*  \param[out] adj: concatenated lists of neighbours
+*
+* Creates a CSR (compressed sparse row) snapshot of the network, ignoring the direction of links. Each list is sorted,
+* without repeated neighbours and without self-loops. Used internally by algorithms that need fast, cache-friendly
+* access to the undirected structure of the network.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::build_undirected_csr(vector<long long> &offset, vector<unsigned int> &adj) const
+{
+    int i;
+
+    offset = vector<long long>(current_size+1, 0);
+
+    //Gather, sort and clean the list of every node. First pass only counts, second pass writes
+    for (int pass=0; pass < 2; pass++)
+    {
+        if (pass == 1)
+        {
+            for (i=0; i < current_size; i++) offset[i+1] += offset[i];
+            adj = vector<unsigned int>(offset[current_size]);
+        }
+
+        #pragma omp parallel
+        {
+            vector<unsigned int> scratch;
+
+            #pragma omp for schedule(dynamic, 256)
+            for (i=0; i < current_size; i++)
+            {
+                scratch.assign(neighs[i].begin(), neighs[i].end());
+                if (i < (int)pointing_in.size()) scratch.insert(scratch.end(), pointing_in[i].begin(), pointing_in[i].end());
+                sort(scratch.begin(), scratch.end());
+                scratch.erase(unique(scratch.begin(), scratch.end()), scratch.end());
+                scratch.erase(remove(scratch.begin(), scratch.end(), (unsigned int)i), scratch.end());
+
+                if (pass == 0) offset[i+1] = scratch.size();
+                else copy(scratch.begin(), scratch.end(), adj.begin() + offset[i]);
+            }
+        }
+    }
+
+    return;
+}
+
+
+/** \brief Counts triangles and computes all the clustering coefficients in one pass
+*  \param[out] clustering: element j is the local clustering coefficient of node j
+*  \param[out] transitivity: global clustering, three times the number of triangles divided by the number of connected triples
+*  \return total number of triangles in the network
+*
+* Links are oriented from lower to higher degree, so every triangle is found exactly once by merging two sorted lists
+* of neighbours, and hubs only need to check a few links. Direction of links is ignored, as well as multiple links and
+* self-loops. Runs in parallel over nodes when compiled with OpenMP.
+*/
+template <class T, typename B>
+long long DirectedCNetwork<T,B>::count_triangles(vector<double> &clustering, double &transitivity) const
+{
+    int i;
+    long long total; //Number of triangles
+    double wedges; //Number of connected triples
+    long long k;
+
+    vector<long long> offset, out_offset;
+    vector<unsigned int> adj, out_adj;
+
+    build_undirected_csr(offset, adj);
+
+    //Orient every link from lower to higher (degree, index). Lists stay sorted by index
+    out_offset = vector<long long>(current_size+1, 0);
+    for (i=0; i < current_size; i++)
+    {
+        for (k=offset[i]; k < offset[i+1]; k++)
+        {
+            long long kj = offset[adj[k]+1] - offset[adj[k]];
+            if (offset[i+1] - offset[i] < kj or (offset[i+1] - offset[i] == kj and i < (int)adj[k])) out_offset[i+1] += 1;
+        }
+    }
+    for (i=0; i < current_size; i++) out_offset[i+1] += out_offset[i];
+    out_adj = vector<unsigned int>(out_offset[current_size]);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i=0; i < current_size; i++)
+    {
+        long long w = out_offset[i];
+        for (long long k=offset[i]; k < offset[i+1]; k++)
+        {
+            long long kj = offset[adj[k]+1] - offset[adj[k]];
+            if (offset[i+1] - offset[i] < kj or (offset[i+1] - offset[i] == kj and i < (int)adj[k]))
+            {
+                out_adj[w] = adj[k];
+                w += 1;
+            }
+        }
+    }
+
+    //Each triangle u->v->w, u->w is found from u by intersecting the lists of u and v
+    vector<long long> triangles(current_size, 0);
+    total = 0;
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:total)
+    for (i=0; i < current_size; i++)
+    {
+        for (long long k=out_offset[i]; k < out_offset[i+1]; k++)
+        {
+            unsigned int v = out_adj[k];
+            long long a = out_offset[i];
+            long long b = out_offset[v];
+            long long found = 0;
+
+            //Merge the two sorted lists
+            while (a < out_offset[i+1] and b < out_offset[v+1])
+            {
+                if (out_adj[a] < out_adj[b]) a += 1;
+                else if (out_adj[a] > out_adj[b]) b += 1;
+                else
+                {
+                    #pragma omp atomic
+                    triangles[out_adj[a]] += 1;
+                    found += 1;
+                    a += 1;
+                    b += 1;
+                }
+            }
+
+            if (found > 0)
+            {
+                #pragma omp atomic
+                triangles[v] += found;
+                #pragma omp atomic
+                triangles[i] += found;
+                total += found;
+            }
+        }
+    }
+
+    //Finish local and global clustering
+    clustering = vector<double>(current_size, 0.0);
+    wedges = 0.0;
+    for (i=0; i < current_size; i++)
+    {
+        k = offset[i+1] - offset[i];
+        if (k > 1)
+        {
+            clustering[i] = 2.0 * triangles[i] / (k * (k - 1.0));
+            wedges += 0.5 * k * (k - 1.0);
+        }
+    }
+    transitivity = wedges > 0.0 ? 3.0 * total / wedges : 0.0;
+
+    return total;
+}
+
+/** \brief Computes the k-core decomposition of the network
+*  \param[out] coreness: element j is the k-shell index of node j
+*  \param[out] ordering: degeneracy ordering. Each node has at most degeneracy neighbours after it in this list.
+*  \param parallel: optional. If true, peel all the nodes of the same shell at once, in parallel with OpenMP.
+*  \return degeneracy of the network, the largest coreness
+*
+* Bucket algorithm of Batagelj and Zaversnik, in O(N+E) time and with only four integers per node. Direction of links is
+* ignored, and the degree of each node is the one given by its lists of neighbours. The parallel version peels shells level
+* by level, which is preferred for large networks; it gives the same coreness, but a different ordering. Each level starts
+* from a bucket of nodes with that degree, so the cost does not grow with the number of levels.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::core_decomposition(vector<int> &coreness, vector<int> &ordering, bool parallel) const
+{
+    int i,j,k;
+    int v,u,w;
+    int du, pu, pw;
+    int max_degree;
+
+    //Undirected networks have everything in neighs
+    bool use_in = directed and (int)pointing_in.size() == current_size;
+
+    vector<int> &deg = coreness; //Degrees are decreased until they become the coreness
+    deg = vector<int>(current_size);
+    ordering = vector<int>(current_size);
+
+    max_degree = 0;
+    for (i=0; i < current_size; i++)
+    {
+        deg[i] = neighs[i].size() + (use_in ? pointing_in[i].size() : 0);
+        max_degree = max(max_degree, deg[i]);
+    }
+
+    if (not parallel)
+    {
+        vector<int> bin(max_degree+1, 0); //Where each degree starts in the sorted list
+        vector<int> pos(current_size); //Position of each node in the sorted list
+        vector<int> &vert = ordering; //Nodes sorted by current degree
+
+        //Bucket sort of nodes by degree
+        for (i=0; i < current_size; i++) bin[deg[i]] += 1;
+        j = 0;
+        for (k=0; k <= max_degree; k++)
+        {
+            int count = bin[k];
+            bin[k] = j;
+            j += count;
+        }
+        for (i=0; i < current_size; i++)
+        {
+            pos[i] = bin[deg[i]];
+            vert[pos[i]] = i;
+            bin[deg[i]] += 1;
+        }
+        for (k=max_degree; k > 0; k--) bin[k] = bin[k-1];
+        bin[0] = 0;
+
+        //Remove nodes in order of degree, moving their neighbours to a lower bucket
+        for (i=0; i < current_size; i++)
+        {
+            v = vert[i];
+            for (j=0; j < (int)(neighs[v].size() + (use_in ? pointing_in[v].size() : 0)); j++)
+            {
+                u = j < (int)neighs[v].size() ? neighs[v][j] : pointing_in[v][j - neighs[v].size()];
+                if (deg[u] > deg[v])
+                {
+                    //Swap u with the first node of its bucket, and move the bucket start
+                    du = deg[u];
+                    pu = pos[u];
+                    pw = bin[du];
+                    w = vert[pw];
+                    if (u != w)
+                    {
+                        pos[u] = pw;
+                        vert[pu] = w;
+                        pos[w] = pu;
+                        vert[pw] = u;
+                    }
+                    bin[du] += 1;
+                    deg[u] -= 1;
+                }
+            }
+        }
+    }
+    else
+    {
+        vector<int> frontier, next, dropped;
+        vector<char> removed(current_size, 0);
+        vector< vector<int> > bucket(max_degree+1); //Candidates to start each level. Some may be outdated
+        vector<int> filed(current_size); //Degree at which each node was last put in a bucket
+        int n_removed = 0;
+
+        for (i=0; i < current_size; i++)
+        {
+            bucket[deg[i]].push_back(i);
+            filed[i] = deg[i];
+        }
+
+        k = 0;
+        while (n_removed < current_size)
+        {
+            //Nodes that belong to the k-shell at the start of this level. All the remaining nodes have degree k or more,
+            //and each one is in the bucket of its current degree, so there is no need to scan all the nodes
+            frontier.clear();
+            for (i=0; i < (int)bucket[k].size(); i++)
+            {
+                v = bucket[k][i];
+                if (not removed[v] and deg[v] == k) frontier.push_back(v);
+            }
+            vector<int>().swap(bucket[k]);
+            dropped.clear();
+
+            while (frontier.size() > 0)
+            {
+                for (i=0; i < (int)frontier.size(); i++)
+                {
+                    removed[frontier[i]] = 1;
+                    ordering[n_removed + i] = frontier[i];
+                }
+                n_removed += frontier.size();
+                next.clear();
+
+                #pragma omp parallel
+                {
+                    vector<int> local_next, local_dropped;
+
+                    #pragma omp for schedule(dynamic, 64)
+                    for (i=0; i < (int)frontier.size(); i++)
+                    {
+                        int v = frontier[i];
+                        int kv = neighs[v].size() + (use_in ? pointing_in[v].size() : 0);
+                        for (int j=0; j < kv; j++)
+                        {
+                            int u = j < (int)neighs[v].size() ? neighs[v][j] : pointing_in[v][j - neighs[v].size()];
+                            if (not removed[u])
+                            {
+                                int old_deg;
+                                #pragma omp atomic capture
+                                old_deg = deg[u]--;
+                                if (old_deg == k+1) local_next.push_back(u); //Exactly one thread sees u entering the shell
+                                else if (old_deg > k+1) local_dropped.push_back(u);
+                            }
+                        }
+                    }
+
+                    #pragma omp critical
+                    {
+                        next.insert(next.end(), local_next.begin(), local_next.end());
+                        dropped.insert(dropped.end(), local_dropped.begin(), local_dropped.end());
+                    }
+                }
+
+                //Nodes in the shell keep k as coreness
+                for (i=0; i < (int)frontier.size(); i++) deg[frontier[i]] = k;
+                swap(frontier, next);
+            }
+
+            //Nodes whose degree dropped but stay above k move to the bucket of their new degree
+            for (i=0; i < (int)dropped.size(); i++)
+            {
+                u = dropped[i];
+                if (not removed[u] and filed[u] != deg[u])
+                {
+                    bucket[deg[u]].push_back(u);
+                    filed[u] = deg[u];
+                }
+            }
+
+            k += 1;
+        }
+    }
+
+    return current_size > 0 ? *max_element(coreness.begin(), coreness.end()) : 0;
+}
+
+
+/** \brief Colors the nodes so that linked nodes have different colors
+*  \param[out] color: color of each node, from 0 to the number of colors - 1
+*  \param[out] class_start: nodes of color c are stored in class_nodes between class_start[c] and class_start[c+1]
+*  \param[out] class_nodes: nodes sorted by color. Each color class is an independent set, so all its nodes can be
+*  updated in parallel in asynchronous dynamics.
+*  \param ordering: optional. Priority of the nodes: RANDOM_ORDER, LARGEST_FIRST (by degree) or SMALLEST_LAST
+*  (degeneracy ordering, default).
+*  \param random_seed: optional. Used to break ties, and for the random ordering.
+*  \return number of colors
+*
+* Parallel Jones-Plassmann algorithm. A node gets the smallest color not used by its neighbours as soon as all its
+* neighbours with higher priority are colored, so all nodes ready in the same round are colored in parallel. The result
+* is the same as the sequential greedy coloring in this order, for any number of threads. Direction of links is ignored.
+* SMALLEST_LAST peels the network without multiple links nor self-loops, so it uses at most d+1 colors, with d the
+* degeneracy of that simple network. It can be lower than the one given by core_decomposition, which counts every entry
+* of the lists of neighbours. How the other orderings compare in colors, rounds and balance of the classes depends on
+* the network: use coloring_statistics to measure them.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::coloring(vector<int> &color, vector<int> &class_start, vector<int> &class_nodes, int ordering, unsigned int random_seed) const
+{
+    int i;
+    int n_colors, rounds;
+
+    vector<long long> offset;
+    vector<unsigned int> adj;
+
+    build_undirected_csr(offset, adj);
+    jones_plassmann(offset, adj, ordering, random_seed, color, rounds);
+
+    //Lay out the classes
+    n_colors = current_size > 0 ? *max_element(color.begin(), color.end()) + 1 : 0;
+    class_start = vector<int>(n_colors+1, 0);
+    for (i=0; i < current_size; i++) class_start[color[i]+1] += 1;
+    for (i=0; i < n_colors; i++) class_start[i+1] += class_start[i];
+    class_nodes = vector<int>(current_size);
+    vector<int> pos(class_start.begin(), class_start.end()-1);
+    for (i=0; i < current_size; i++)
+    {
+        class_nodes[pos[color[i]]] = i;
+        pos[color[i]] += 1;
+    }
+
+    return n_colors;
+}
+
+
+/** \brief Compares the node orderings available for coloring
+*  \param[out] n_colors: element o is the number of colors used with ordering o (RANDOM_ORDER, LARGEST_FIRST, SMALLEST_LAST)
+*  \param[out] rounds: element o is the number of parallel Jones-Plassmann rounds needed with ordering o
+*  \param[out] class_sizes: class_sizes[o][c] is the number of nodes with color c for ordering o
+*  \param[out] hub_colors: element o is the number of different colors given to the hubs with ordering o
+*  \param n_hubs: optional. Number of nodes of largest degree counted as hubs. Default: 100.
+*  \param random_seed: optional. Same meaning as in coloring.
+*
+* Each ordering gives the same colors as a call to coloring with the same seed. Fewer colors means fewer sweeps in
+* asynchronous dynamics, fewer rounds means a faster coloring, and balanced classes give more parallel work per sweep.
+* Direction of links is ignored.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::coloring_statistics(vector<int> &n_colors, vector<int> &rounds, vector< vector<int> > &class_sizes, vector<int> &hub_colors,
+                                                int n_hubs, unsigned int random_seed) const
+{
+    int i, o;
+
+    vector<long long> offset;
+    vector<unsigned int> adj;
+    vector<int> color, hubs(current_size);
+
+    build_undirected_csr(offset, adj);
+
+    //Hubs are the nodes of largest degree
+    n_hubs = max(0, min(n_hubs, current_size));
+    for (i=0; i < current_size; i++) hubs[i] = i;
+    partial_sort(hubs.begin(), hubs.begin() + n_hubs, hubs.end(),
+                 [&offset](int a, int b) -> bool {return offset[a+1] - offset[a] > offset[b+1] - offset[b];});
+    hubs.resize(n_hubs);
+
+    n_colors = vector<int>(3, 0);
+    rounds = vector<int>(3, 0);
+    class_sizes = vector< vector<int> >(3);
+    hub_colors = vector<int>(3, 0);
+
+    for (o=RANDOM_ORDER; o <= SMALLEST_LAST; o++)
+    {
+        jones_plassmann(offset, adj, o, random_seed, color, rounds[o]);
+
+        n_colors[o] = current_size > 0 ? *max_element(color.begin(), color.end()) + 1 : 0;
+        class_sizes[o] = vector<int>(n_colors[o], 0);
+        for (i=0; i < current_size; i++) class_sizes[o][color[i]] += 1;
+
+        vector<int> hub_palette;
+        for (i=0; i < n_hubs; i++) hub_palette.push_back(color[hubs[i]]);
+        sort(hub_palette.begin(), hub_palette.end());
+        hub_colors[o] = unique(hub_palette.begin(), hub_palette.end()) - hub_palette.begin();
+    }
+
+    return;
+}
+
+
+/** \brief Degeneracy ordering of an undirected CSR
+*  \param offset, adj: undirected CSR from build_undirected_csr
+*  \param[out] order: nodes in the order they are peeled. Each node has at most degeneracy neighbours after it.
+*
+* Same bucket algorithm as the serial core_decomposition, but over the clean lists of the CSR.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::degeneracy_ordering(const vector<long long> &offset, const vector<unsigned int> &adj, vector<int> &order) const
+{
+    int i, j, k;
+    int v, u, w;
+    int du, pu, pw;
+    int max_degree;
+
+    vector<int> deg(current_size);
+    vector<int> pos(current_size); //Position of each node in order
+    vector<int> bin; //Where each degree starts in order
+
+    max_degree = 0;
+    for (i=0; i < current_size; i++)
+    {
+        deg[i] = offset[i+1] - offset[i];
+        max_degree = max(max_degree, deg[i]);
+    }
+
+    //Bucket sort of nodes by degree
+    bin = vector<int>(max_degree+1, 0);
+    order = vector<int>(current_size);
+    for (i=0; i < current_size; i++) bin[deg[i]] += 1;
+    j = 0;
+    for (k=0; k <= max_degree; k++)
+    {
+        int count = bin[k];
+        bin[k] = j;
+        j += count;
+    }
+    for (i=0; i < current_size; i++)
+    {
+        pos[i] = bin[deg[i]];
+        order[pos[i]] = i;
+        bin[deg[i]] += 1;
+    }
+    for (k=max_degree; k > 0; k--) bin[k] = bin[k-1];
+    bin[0] = 0;
+
+    //Remove nodes in order of degree, moving their neighbours to a lower bucket
+    for (i=0; i < current_size; i++)
+    {
+        v = order[i];
+        for (long long l=offset[v]; l < offset[v+1]; l++)
+        {
+            u = adj[l];
+            if (deg[u] > deg[v])
+            {
+                du = deg[u];
+                pu = pos[u];
+                pw = bin[du];
+                w = order[pw];
+                if (u != w)
+                {
+                    pos[u] = pw;
+                    order[pu] = w;
+                    pos[w] = pu;
+                    order[pw] = u;
+                }
+                bin[du] += 1;
+                deg[u] -= 1;
+            }
+        }
+    }
+
+    return;
+}
+
+
+/** \brief Parallel Jones-Plassmann coloring over an undirected CSR
+*  \param offset, adj: undirected CSR from build_undirected_csr
+*  \param ordering: priority of the nodes, as in coloring
+*  \param random_seed: used to break ties, and for the random ordering
+*  \param[out] color: color of each node
+*  \param[out] rounds: number of parallel rounds
+*  \return number of colors
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::jones_plassmann(const vector<long long> &offset, const vector<unsigned int> &adj, int ordering, unsigned int random_seed,
+                                           vector<int> &color, int &rounds) const
+{
+    int i;
+    int n_colors;
+
+    vector<long long> priority(current_size);
+    vector<int> waiting(current_size, 0); //Neighbours with higher priority still uncolored
+    vector<int> frontier, next_frontier;
+    //Priority of each node. Higher ones are colored first. Ties broken with a random number
+    rng_stream gen(random_seed);
+    if (ordering == SMALLEST_LAST)
+    {
+        vector<int> order;
+        degeneracy_ordering(offset, adj, order);
+        for (i=0; i < current_size; i++) priority[order[i]] = i;
+    }
+    else
+    {
+        for (i=0; i < current_size; i++)
+        {
+            long long degree = ordering == LARGEST_FIRST ? offset[i+1] - offset[i] : 0;
+            priority[i] = (degree << 32) | (gen() >> 32);
+        }
+    }
+    //Equal priorities are broken by index
+    auto higher = [&priority](int a, int b) -> bool {return priority[a] > priority[b] or (priority[a] == priority[b] and a > b);};
+
+    color = vector<int>(current_size, -1);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i=0; i < current_size; i++)
+    {
+        for (long long k=offset[i]; k < offset[i+1]; k++) if (higher(adj[k], i)) waiting[i] += 1;
+    }
+    for (i=0; i < current_size; i++) if (waiting[i] == 0) frontier.push_back(i);
+
+    n_colors = 0;
+    rounds = 0;
+    while (frontier.size() > 0)
+    {
+        rounds += 1;
+        next_frontier.clear();
+
+        #pragma omp parallel reduction(max:n_colors)
+        {
+            vector<int> used; //used[c] == v if color c is taken by a neighbour of v
+            vector<int> local;
+
+            #pragma omp for schedule(dynamic, 64)
+            for (i=0; i < (int)frontier.size(); i++)
+            {
+                int v = frontier[i];
+                long long k;
+                int c;
+
+                //Smallest free color. Neighbours colored now have lower priority, so they are not colored yet
+                if ((long long)used.size() < offset[v+1] - offset[v] + 1) used.resize(offset[v+1] - offset[v] + 1, -1);
+                for (k=offset[v]; k < offset[v+1]; k++)
+                {
+                    c = color[adj[k]];
+                    if (c >= 0 and c < (int)used.size()) used[c] = v;
+                }
+                c = 0;
+                while (c < (int)used.size() and used[c] == v) c++;
+                color[v] = c;
+                n_colors = max(n_colors, c+1);
+
+                //Release the neighbours with lower priority
+                for (k=offset[v]; k < offset[v+1]; k++)
+                {
+                    int w = adj[k];
+                    if (higher(v, w))
+                    {
+                        int left;
+                        #pragma omp atomic capture
+                        left = --waiting[w];
+                        if (left == 0) local.push_back(w);
+                    }
+                }
+            }
+
+            #pragma omp critical
+            next_frontier.insert(next_frontier.end(), local.begin(), local.end());
+        }
+
+        swap(frontier, next_frontier);
+    }
+
+    return n_colors;
+}
+
+
+/** \brief Finds a maximal independent set with Luby's algorithm
+*  \param[out] nodes: sorted list of nodes in the set. No two of them are linked, and every other node is linked to one of them.
+*  \param random_seed: optional. Seed of the random priorities.
+*  \return size of the set
+*
+* Each node gets a random priority. In every round, all undecided nodes with higher priority than their undecided
+* neighbours join the set in parallel, and their neighbours leave. Finishes in O(log N) rounds with high probability.
+* The set depends only on the seed. Direction of links is ignored.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::independent_set(vector<int> &nodes, unsigned int random_seed) const
+{
+    int i;
+    bool undecided_left;
+
+    vector<long long> offset;
+    vector<unsigned int> adj;
+    vector<unsigned long long> priority(current_size);
+    vector<char> state(current_size, 0); //0 undecided, 1 in the set, 2 out of the set
+    vector<char> joins(current_size, 0);
+
+    build_undirected_csr(offset, adj);
+
+    for (i=0; i < current_size; i++) priority[i] = rng_stream::mix(random_seed ^ rng_stream::mix(i + 0x9E3779B97F4A7C15ULL));
+
+    undecided_left = current_size > 0;
+    while (undecided_left)
+    {
+        //Local maxima among the undecided nodes join
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (i=0; i < current_size; i++)
+        {
+            joins[i] = 0;
+            if (state[i] != 0) continue;
+            bool is_max = true;
+            for (long long k=offset[i]; k < offset[i+1] and is_max; k++)
+            {
+                int w = adj[k];
+                if (state[w] == 0 and (priority[w] > priority[i] or (priority[w] == priority[i] and w > i))) is_max = false;
+            }
+            joins[i] = is_max;
+        }
+
+        //Then their neighbours leave
+        undecided_left = false;
+        #pragma omp parallel for schedule(dynamic, 256) reduction(||:undecided_left)
+        for (i=0; i < current_size; i++)
+        {
+            if (state[i] != 0) continue;
+            if (joins[i]) state[i] = 1;
+            else
+            {
+                for (long long k=offset[i]; k < offset[i+1]; k++)
+                {
+                    if (joins[adj[k]])
+                    {
+                        state[i] = 2;
+                        break;
+                    }
+                }
+                undecided_left = undecided_left or state[i] == 0;
+            }
+        }
+    }
+
+    nodes.clear();
+    for (i=0; i < current_size; i++) if (state[i] == 1) nodes.push_back(i);
+
+    return nodes.size();
+}
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Computes the modularity of a partition of the network
+*  \param community: element j is the community of node j. Labels must be between 0 and current_size-1.
+*  \param weighted: optional. If true, use the weights of the links.
+*  \param resolution: optional. Resolution parameter multiplying the null model. Default: 1
+*  \return modularity of the partition
+*
+* Newman's modularity, ignoring the direction of links.
+*/
+template <class T, typename B>
+double DirectedCNetwork<T,B>::modularity(const vector<int> &community, bool weighted, double resolution) const
+{
+    int i;
+    double w, total, q;
+
+    vector<double> inside(current_size, 0.0); //Twice the weight inside each community
+    vector<double> tot(current_size, 0.0); //Sum of strengths of each community
+
+    total = 0.0;
+    for (i=0; i < link_count; i++)
+    {
+        w = weighted ? (double)adjm.m[i].value : 1.0;
+        if (community[adjm.m[i].x] == community[adjm.m[i].y]) inside[community[adjm.m[i].x]] += 2.0 * w;
+        tot[community[adjm.m[i].x]] += w;
+        tot[community[adjm.m[i].y]] += w;
+        total += 2.0 * w;
+    }
+
+    q = 0.0;
+    if (total > 0.0)
+    {
+        for (i=0; i < current_size; i++) q += inside[i] / total - resolution * (tot[i] / total) * (tot[i] / total);
+    }
+    return q;
+}
+
+
+/** \brief Finds communities maximizing modularity with the Louvain method
+*  \param[out] community: element j is the community of node j. Labels go from 0 to the number of communities - 1.
+*  \param weighted: optional. If true, use the weights of the links stored in adjm.
+*  \param leiden_refinement: optional. If true (default), refine communities before aggregation as in the Leiden algorithm, which guarantees connected communities.
+*  \param resolution: optional. Resolution parameter. Default: 1
+*  \param random_seed: optional, default 123456789. The same seed gives the same partition, for any number of threads.
+*  \return modularity of the partition found
+*
+* Multilevel Louvain algorithm. In the local moving phase nodes are visited in random order, in blocks which are evaluated
+* in parallel when compiled with OpenMP and then applied. With refinement, each community is split into well-connected
+* subcommunities, which become the nodes of the next level. The coarse networks are built directly in CSR form.
+* Direction of links is ignored.
+*/
+template <class T, typename B>
+double DirectedCNetwork<T,B>::louvain(vector<int> &community, bool weighted, bool leiden_refinement, double resolution, unsigned int random_seed) const
+{
+    int i, level;
+    int n_cur, n_parts, n_comm;
+    unsigned int x, y;
+    double w, total;
+
+    vector<long long> offset, new_offset;
+    vector<int> adj, new_adj;
+    vector<double> weight, new_weight, strength;
+    vector<int> comm, refined, label, node_map;
+
+    community = vector<int>(current_size, 0);
+    if (current_size == 0) return 0.0;
+
+    //Build the first level from the list of links. A self-loop is stored once, with twice its weight
+    offset = vector<long long>(current_size+1, 0);
+    for (i=0; i < link_count; i++)
+    {
+        offset[adjm.m[i].x+1] += 1;
+        if (adjm.m[i].x != adjm.m[i].y) offset[adjm.m[i].y+1] += 1;
+    }
+    for (i=0; i < current_size; i++) offset[i+1] += offset[i];
+    adj = vector<int>(offset[current_size]);
+    weight = vector<double>(offset[current_size]);
+    vector<long long> pos(offset.begin(), offset.end()-1);
+    for (i=0; i < link_count; i++)
+    {
+        x = adjm.m[i].x;
+        y = adjm.m[i].y;
+        w = weighted ? (double)adjm.m[i].value : 1.0;
+        if (x != y)
+        {
+            adj[pos[x]] = y;
+            weight[pos[x]] = w;
+            pos[x] += 1;
+            adj[pos[y]] = x;
+            weight[pos[y]] = w;
+            pos[y] += 1;
+        }
+        else
+        {
+            adj[pos[x]] = x;
+            weight[pos[x]] = 2.0 * w;
+            pos[x] += 1;
+        }
+    }
+
+    n_cur = current_size;
+    node_map = vector<int>(current_size);
+    comm = vector<int>(current_size);
+    for (i=0; i < current_size; i++)
+    {
+        node_map[i] = i;
+        comm[i] = i;
+    }
+
+    level = 0;
+    while (true)
+    {
+        //Strength of each node and total weight
+        strength = vector<double>(n_cur, 0.0);
+        for (i=0; i < n_cur; i++) for (long long e=offset[i]; e < offset[i+1]; e++) strength[i] += weight[e];
+        total = 0.0;
+        for (i=0; i < n_cur; i++) total += strength[i];
+        if (total == 0.0) break;
+
+        louvain_move(offset, adj, weight, strength, total, resolution, comm, 2*level, random_seed);
+
+        if (leiden_refinement) louvain_refine(offset, adj, weight, strength, total, resolution, comm, refined, 2*level+1, random_seed);
+        else refined = comm;
+
+        //Relabel the parts with consecutive integers
+        label = vector<int>(n_cur, -1);
+        n_parts = 0;
+        for (i=0; i < n_cur; i++)
+        {
+            if (label[refined[i]] < 0)
+            {
+                label[refined[i]] = n_parts;
+                n_parts += 1;
+            }
+            refined[i] = label[refined[i]];
+        }
+
+        if (n_parts == n_cur) break; //Nothing was merged, so we are done
+
+        //Initial communities of the next level are the ones found by the moving phase
+        vector<int> next_comm(n_parts);
+        label = vector<int>(n_cur, -1);
+        n_comm = 0;
+        for (i=0; i < n_cur; i++)
+        {
+            if (label[comm[i]] < 0)
+            {
+                label[comm[i]] = n_comm;
+                n_comm += 1;
+            }
+            next_comm[refined[i]] = label[comm[i]];
+        }
+
+        for (i=0; i < current_size; i++) node_map[i] = refined[node_map[i]];
+
+        louvain_aggregate(offset, adj, weight, refined, n_parts, new_offset, new_adj, new_weight);
+        swap(offset, new_offset);
+        swap(adj, new_adj);
+        swap(weight, new_weight);
+        comm = next_comm;
+        n_cur = n_parts;
+        level += 1;
+    }
+
+    //Communities of the original nodes, with consecutive labels
+    label = vector<int>(n_cur, -1);
+    n_comm = 0;
+    for (i=0; i < current_size; i++)
+    {
+        int c = comm[node_map[i]];
+        if (label[c] < 0)
+        {
+            label[c] = n_comm;
+            n_comm += 1;
+        }
+        community[i] = label[c];
+    }
+
+    return modularity(community, weighted, resolution);
+}
+
+
+/** \brief Local moving phase of the Louvain method
+*  \param offset, adj, weight: CSR representation of the current level
+*  \param strength: sum of weights of each node
+*  \param total: sum of all strengths
+*  \param resolution: resolution parameter
+*  \param comm: community of each node, updated in place
+*  \param stream: random stream used for the order of the nodes
+*  \param random_seed: seed of the random streams
+*  \return true if any node changed its community
+*
+* Nodes are visited in random order and moved to the neighbouring community with largest modularity gain, until
+* no node moves. Nodes are processed in blocks: the best move of every node in the block is evaluated in parallel with
+* the communities fixed, and then all of them are applied. Accumulators are dense arrays cleaned through a list of
+* touched communities. A singleton node does not move to another singleton with larger label, to avoid swaps.
+*/
+template <class T, typename B>
+bool DirectedCNetwork<T,B>::louvain_move(const vector<long long> &offset, const vector<int> &adj, const vector<double> &weight, const vector<double> &strength,
+                                         double total, double resolution, vector<int> &comm, unsigned long long stream, unsigned int random_seed) const
+{
+    int i, b;
+    int n = strength.size();
+    int block_size = max(1, n / 256); //Nodes evaluated at once
+    int moved, pass;
+    bool any_moved = false;
+
+    vector<double> tot(n, 0.0); //Sum of strengths of each community
+    vector<int> size(n, 0); //Nodes in each community
+    vector<int> order(n), target(n);
+
+    for (i=0; i < n; i++)
+    {
+        tot[comm[i]] += strength[i];
+        size[comm[i]] += 1;
+        order[i] = i;
+    }
+
+    rng_stream gen(random_seed, stream);
+    shuffle(order.begin(), order.end(), gen);
+
+    pass = 0;
+    do
+    {
+        moved = 0;
+
+        #pragma omp parallel private(b)
+        {
+            vector<double> acc(n, 0.0); //Weight from the node to each community
+            vector<int> seen; //Communities touched
+
+            for (b=0; b < n; b += block_size)
+            {
+                int block_end = min(n, b + block_size);
+
+                #pragma omp for schedule(dynamic, 64)
+                for (i=b; i < block_end; i++)
+                {
+                    int u = order[i];
+                    int cu = comm[u];
+                    int best;
+                    double gain, best_gain;
+
+                    for (long long e=offset[u]; e < offset[u+1]; e++)
+                    {
+                        int c = comm[adj[e]];
+                        if (adj[e] == u) continue;
+                        if (acc[c] == 0.0) seen.push_back(c);
+                        acc[c] += weight[e];
+                    }
+
+                    //Staying is compared with the rest of the community, without u
+                    best = cu;
+                    best_gain = acc[cu] - resolution * strength[u] * (tot[cu] - strength[u]) / total;
+                    for (int j=0; j < (int)seen.size(); j++)
+                    {
+                        int c = seen[j];
+                        if (c == cu) continue;
+                        gain = acc[c] - resolution * strength[u] * tot[c] / total;
+                        if (gain > best_gain + 1e-12 or (fabs(gain - best_gain) <= 1e-12 and c < best and best != cu))
+                        {
+                            best = c;
+                            best_gain = gain;
+                        }
+                    }
+                    if (best != cu and size[cu] == 1 and size[best] == 1 and best > cu) best = cu;
+
+                    target[i] = best;
+
+                    for (int j=0; j < (int)seen.size(); j++) acc[seen[j]] = 0.0;
+                    seen.clear();
+                }
+
+                //Apply the moves of the block
+                #pragma omp single
+                {
+                    for (int j=b; j < block_end; j++)
+                    {
+                        int u = order[j];
+                        if (target[j] != comm[u])
+                        {
+                            tot[comm[u]] -= strength[u];
+                            size[comm[u]] -= 1;
+                            tot[target[j]] += strength[u];
+                            size[target[j]] += 1;
+                            comm[u] = target[j];
+                            moved += 1;
+                        }
+                    }
+                }
+            }
+        }
+
+        any_moved = any_moved or moved > 0;
+        pass += 1;
+    }
+    while (moved > 0 and pass < 100);
+
+    return any_moved;
+}
+
+
+/** \brief Refinement phase of the Leiden algorithm
+*  \param offset, adj, weight: CSR representation of the current level
+*  \param strength: sum of weights of each node
+*  \param total: sum of all strengths
+*  \param resolution: resolution parameter
+*  \param comm: community of each node, given by the moving phase
+*  \param[out] refined: subcommunity of each node. Each subcommunity is inside a single community.
+*  \param stream: random stream used for the order of the nodes
+*  \param random_seed: seed of the random streams
+*
+* Each community is split in singletons, which are merged greedily, in random order, only with well-connected subcommunities of the
+* same community. Communities are independent, so they are refined in parallel, each one with its own random stream.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::louvain_refine(const vector<long long> &offset, const vector<int> &adj, const vector<double> &weight, const vector<double> &strength,
+                                           double total, double resolution, const vector<int> &comm, vector<int> &refined, unsigned long long stream, unsigned int random_seed) const
+{
+    int i;
+    int n = strength.size();
+
+    vector<double> tot(n, 0.0); //Sum of strengths of each community
+    vector<double> rtot(strength); //Sum of strengths of each subcommunity
+    vector<double> rext(n, 0.0); //Weight from each subcommunity to the rest of its community
+    vector<int> rsize(n, 1); //Nodes in each subcommunity
+    vector<int> start(n+1, 0), members(n);
+
+    refined = vector<int>(n);
+    for (i=0; i < n; i++)
+    {
+        refined[i] = i;
+        tot[comm[i]] += strength[i];
+        start[comm[i]+1] += 1;
+    }
+
+    //Group the nodes of each community
+    for (i=0; i < n; i++) start[i+1] += start[i];
+    vector<int> pos(start.begin(), start.end()-1);
+    for (i=0; i < n; i++)
+    {
+        members[pos[comm[i]]] = i;
+        pos[comm[i]] += 1;
+    }
+
+    //Weight of each node to the rest of its community
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i=0; i < n; i++)
+    {
+        for (long long e=offset[i]; e < offset[i+1]; e++) if (adj[e] != i and comm[adj[e]] == comm[i]) rext[i] += weight[e];
+    }
+
+    #pragma omp parallel
+    {
+        vector<double> acc(n, 0.0);
+        vector<int> seen;
+
+        #pragma omp for schedule(dynamic, 16)
+        for (i=0; i < n; i++)
+        {
+            if (start[i+1] - start[i] < 2) continue; //Empty or singleton community
+
+            int c = i;
+            double kc = tot[c];
+            rng_stream gen(random_seed ^ stream, c);
+            shuffle(members.begin() + start[c], members.begin() + start[c+1], gen);
+
+            for (int m=start[c]; m < start[c+1]; m++)
+            {
+                int v = members[m];
+                if (rsize[refined[v]] != 1) continue; //Only singletons are moved
+
+                //Node must be well connected to its community
+                double kv_c = rext[v];
+                if (kv_c < resolution * strength[v] * (kc - strength[v]) / total) continue;
+
+                for (long long e=offset[v]; e < offset[v+1]; e++)
+                {
+                    int u = adj[e];
+                    if (u == v or comm[u] != c) continue;
+                    int r = refined[u];
+                    if (acc[r] == 0.0) seen.push_back(r);
+                    acc[r] += weight[e];
+                }
+
+                //Greedy choice among well-connected subcommunities with non-negative gain
+                int best = refined[v];
+                double best_gain = 0.0;
+                for (int j=0; j < (int)seen.size(); j++)
+                {
+                    int r = seen[j];
+                    if (r == refined[v]) continue;
+                    if (rext[r] < resolution * rtot[r] * (kc - rtot[r]) / total) continue;
+                    double gain = acc[r] - resolution * strength[v] * rtot[r] / total;
+                    if (gain > best_gain + 1e-12 or (fabs(gain - best_gain) <= 1e-12 and best != refined[v] and r < best))
+                    {
+                        best = r;
+                        best_gain = gain;
+                    }
+                }
+
+                if (best != refined[v])
+                {
+                    int old = refined[v];
+                    rext[best] += rext[v] - 2.0 * acc[best];
+                    rtot[best] += strength[v];
+                    rsize[best] += 1;
+                    rtot[old] = 0.0;
+                    rsize[old] = 0;
+                    refined[v] = best;
+                }
+
+                for (int j=0; j < (int)seen.size(); j++) acc[seen[j]] = 0.0;
+                seen.clear();
+            }
+        }
+    }
+
+    return;
+}
+
+
+/** \brief Builds the coarse network for the next Louvain level
+*  \param offset, adj, weight: CSR representation of the current level
+*  \param part: part of each node, with labels between 0 and n_parts-1
+*  \param n_parts: number of parts, which are the nodes of the coarse network
+*  \param[out] new_offset, new_adj, new_weight: CSR representation of the coarse network
+*
+* Links between nodes of the same parts are summed. Links inside a part become a self-loop. The coarse network is
+* written directly in CSR form: a first parallel pass counts the links of each part and a second one writes them.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::louvain_aggregate(const vector<long long> &offset, const vector<int> &adj, const vector<double> &weight, const vector<int> &part, int n_parts,
+                                              vector<long long> &new_offset, vector<int> &new_adj, vector<double> &new_weight) const
+{
+    int i;
+    int n = part.size();
+
+    vector<int> start(n_parts+1, 0), members(n);
+
+    //Group the nodes of each part
+    for (i=0; i < n; i++) start[part[i]+1] += 1;
+    for (i=0; i < n_parts; i++) start[i+1] += start[i];
+    vector<int> pos(start.begin(), start.end()-1);
+    for (i=0; i < n; i++)
+    {
+        members[pos[part[i]]] = i;
+        pos[part[i]] += 1;
+    }
+
+    new_offset = vector<long long>(n_parts+1, 0);
+    for (int pass=0; pass < 2; pass++)
+    {
+        if (pass == 1)
+        {
+            for (i=0; i < n_parts; i++) new_offset[i+1] += new_offset[i];
+            new_adj = vector<int>(new_offset[n_parts]);
+            new_weight = vector<double>(new_offset[n_parts]);
+        }
+
+        #pragma omp parallel
+        {
+            vector<double> acc(n_parts, 0.0);
+            vector<char> is_seen(n_parts, 0);
+            vector<int> seen;
+
+            #pragma omp for schedule(dynamic, 64)
+            for (i=0; i < n_parts; i++)
+            {
+                for (int m=start[i]; m < start[i+1]; m++)
+                {
+                    int u = members[m];
+                    for (long long e=offset[u]; e < offset[u+1]; e++)
+                    {
+                        int d = part[adj[e]];
+                        if (not is_seen[d])
+                        {
+                            is_seen[d] = 1;
+                            seen.push_back(d);
+                        }
+                        acc[d] += weight[e];
+                    }
+                }
+
+                if (pass == 0) new_offset[i+1] = seen.size();
+                for (int j=0; j < (int)seen.size(); j++)
+                {
+                    if (pass == 1)
+                    {
+                        new_adj[new_offset[i] + j] = seen[j];
+                        new_weight[new_offset[i] + j] = acc[seen[j]];
+                    }
+                    acc[seen[j]] = 0.0;
+                    is_seen[seen[j]] = 0;
+                }
+                seen.clear();
+            }
+        }
+    }
+
+    return;
+}
+
+
+/** \brief Checks if two nodes are linked in any direction
+*  \param a: first node
+*  \param b: second node
+*  \return true if there is a link from a to b or from b to a
+*
+* Looks for the link in the shortest list of neighbours, so it is fast even if one of the nodes is a hub.
+*/
+template <class T, typename B>
+bool DirectedCNetwork<T,B>::are_linked(int a, int b) const
+{
+    int ka = neighs[a].size() + (a < (int)pointing_in.size() ? pointing_in[a].size() : 0);
+    int kb = neighs[b].size() + (b < (int)pointing_in.size() ? pointing_in[b].size() : 0);
+
+    if (kb < ka) swap(a, b); //Search in the smallest list
+
+    if (find(neighs[a].begin(), neighs[a].end(), b) != neighs[a].end()) return true;
+    else if (a < (int)pointing_in.size()) return find(pointing_in[a].begin(), pointing_in[a].end(), b) != pointing_in[a].end();
+    else return false;
+}
+
+
+/** \brief Estimates the fraction of closed wedges by sampling
+*  \param cumulative: cumulative number of raw pairs of neighbours of each node, counting repeated entries, used to select
+*  the center of the wedges. If empty, centers are uniformly selected.
+*  \param node_index: if non-negative, all wedges are centered in this node.
+*  \param clean: if node_index is non-negative, its list of neighbours without repetitions nor self-loops. Unused otherwise.
+*  \param[out] error: half-width of the 95% confidence interval of the estimation
+*  \param max_samples: maximum number of wedges to sample
+*  \param target_error: stop as soon as error is below this value. If zero, all the samples are used.
+*  \param random_seed: seed for the random streams.
+*  \return fraction of sampled wedges which were closed
+*
+* Samples are done in blocks with their own random stream, so results do not depend on the number of threads.
+* A center with less than two different neighbours counts as an open wedge. When sampling over the network, pairs are
+* drawn from the raw lists, without cleaning them: pairs with a repeated end or a self-loop are rejected, and a pair
+* whose ends appear m_a and m_d times is kept with probability 1/(m_a m_d). In this way each wedge of the simple graph
+* is equally likely, and reciprocal or multiple links are not counted twice.
+*/
+template <class T, typename B>
+double DirectedCNetwork<T,B>::wedge_sampling(const vector<double> &cumulative, int node_index, const vector<unsigned int> &clean,
+                                             double &error, int max_samples, double target_error, unsigned int random_seed) const
+{
+    const int block_size = 1024; //Samples done by each random stream
+    const int round_blocks = 64; //Blocks done between checks of the error
+    const int max_tries = 4096; //Rejected pairs before giving up a sample as an open wedge
+
+    int b;
+    int done; //Samples done
+    long long closed; //Closed wedges found
+    int next_block;
+    double p;
+
+    //Raw lists, with direction of links ignored
+    auto raw_degree = [this](int v) -> long long {return neighs[v].size() + (v < (int)pointing_in.size() ? pointing_in[v].size() : 0);};
+    auto raw_neigh = [this](int v, long long pos) -> int {return pos < (long long)neighs[v].size() ? neighs[v][pos] : pointing_in[v][pos - neighs[v].size()];};
+
+    //Times that x appears in the lists of c. It is the same as c in the lists of x, so the shortest ones are used
+    auto multiplicity = [this, &raw_degree](int c, int x) -> long long
+    {
+        if (raw_degree(x) < raw_degree(c)) swap(c, x);
+        long long m = count(neighs[c].begin(), neighs[c].end(), (unsigned int)x);
+        if (c < (int)pointing_in.size()) m += count(pointing_in[c].begin(), pointing_in[c].end(), (unsigned int)x);
+        return m;
+    };
+
+    //True if v has at least two different neighbours, apart from itself
+    auto has_wedges = [&raw_degree, &raw_neigh](int v) -> bool
+    {
+        long long k = raw_degree(v);
+        int first = -1;
+        for (long long j=0; j < k; j++)
+        {
+            int x = raw_neigh(v, j);
+            if (x == v or x == first) continue;
+            else if (first < 0) first = x;
+            else return true;
+        }
+        return false;
+    };
+
+    done = 0;
+    closed = 0;
+    next_block = 0;
+    error = 1.0;
+    p = 0.0;
+    while (done < max_samples and (target_error <= 0.0 or error > target_error))
+    {
+        int blocks = min(round_blocks, (max_samples - done + block_size - 1) / block_size);
+
+        #pragma omp parallel for schedule(dynamic, 1) reduction(+:closed,done)
+        for (b=0; b < blocks; b++)
+        {
+            rng_stream gen(random_seed, next_block + b);
+            int n_samples = min(block_size, max_samples - (next_block + b) * block_size);
+
+            for (int s=0; s < n_samples; s++)
+            {
+                int c, a, d, tries;
+                long long k;
+                unsigned long long u,v;
+
+                if (node_index >= 0)
+                {
+                    //Clean list given, so a, d and c are all different
+                    k = clean.size();
+                    if (k > 1)
+                    {
+                        u = gen.below(k);
+                        v = gen.below(k-1);
+                        if (v >= u) v += 1;
+                        if (are_linked(clean[u], clean[v])) closed += 1;
+                    }
+                }
+                else
+                {
+                    //Uniform centers are kept during the tries, so those without wedges are detected first
+                    c = cumulative.size() == 0 ? gen.below(current_size) : -1;
+                    if (c >= 0 and not has_wedges(c)) tries = max_tries;
+                    else tries = 0;
+
+                    for (; tries < max_tries; tries++)
+                    {
+                        if (cumulative.size() > 0) c = upper_bound(cumulative.begin(), cumulative.end(), gen.uniform() * cumulative.back()) - cumulative.begin();
+                        k = raw_degree(c);
+
+                        //Select a pair of different positions in the raw list of neighbours
+                        u = gen.below(k);
+                        v = gen.below(k-1);
+                        if (v >= u) v += 1;
+                        a = raw_neigh(c, u);
+                        d = raw_neigh(c, v);
+
+                        if (a == d or a == c or d == c) continue;
+                        long long m = multiplicity(c, a) * multiplicity(c, d);
+                        if (m > 1 and gen.uniform() * m >= 1.0) continue;
+
+                        if (are_linked(a, d)) closed += 1;
+                        break;
+                    }
+                }
+                done += 1;
+            }
+        }
+        next_block += blocks;
+
+        p = done > 0 ? 1.0 * closed / done : 0.0;
+        error = 1.96 * sqrt(max(p * (1.0 - p), 1.0 / done) / done); //Avoid zero error when p is 0 or 1
+    }
+
+    return p;
+}
+
+
+/** \brief Estimates the transitivity of the network
+*  \param[out] error: half-width of the 95% confidence interval of the estimation
+*  \param max_samples: optional. Maximum number of wedges to sample. Default: 10^6.
+*  \param target_error: optional. If positive, stop sampling when error is below this value.
+*  \param random_seed: optional, default 123456789.
+*  \return estimated transitivity
+*
+* Uniform wedge sampling: the center of a wedge is selected with probability proportional to its number of wedges,
+* and it is checked if the two ends are linked. Apart from one pass over the degrees, the cost does not depend on the
+* number of links, which is useful when even count_triangles is too slow. Direction of links is ignored, as well as
+* multiple links and self-loops.
+*/
+template <class T, typename B>
+double DirectedCNetwork<T,B>::approx_transitivity(double &error, int max_samples, double target_error, unsigned int random_seed) const
+{
+    int i;
+    double k;
+    vector<double> cumulative(current_size);
+
+    //Raw pairs of neighbours of each node. Wedges with repeated ends are rejected while sampling
+    for (i=0; i < current_size; i++)
+    {
+        k = neighs[i].size() + (i < (int)pointing_in.size() ? pointing_in[i].size() : 0);
+        cumulative[i] = (i > 0 ? cumulative[i-1] : 0.0) + 0.5 * k * (k - 1.0);
+    }
+
+    if (current_size == 0 or cumulative.back() == 0.0)
+    {
+        error = 0.0;
+        return 0.0;
+    }
+
+    return wedge_sampling(cumulative, -1, vector<unsigned int>(), error, max_samples, target_error, random_seed);
+}
+
+
+/** \brief Estimates the average clustering coefficient of the network
+*  \param[out] error: half-width of the 95% confidence interval of the estimation
+*  \param max_samples: optional. Maximum number of nodes to sample. Default: 10^6.
+*  \param target_error: optional. If positive, stop sampling when error is below this value.
+*  \param random_seed: optional, default 123456789.
+*  \return estimated average clustering coefficient
+*
+* Selects a node uniformly and checks if a random pair of its neighbours is linked. The fraction of closed pairs
+* is an unbiased estimation of the average clustering coefficient, with nodes of degree less than two counting as zero.
+* Direction of links is ignored, as well as multiple links and self-loops.
+*/
+template <class T, typename B>
+double DirectedCNetwork<T,B>::approx_mean_clustering(double &error, int max_samples, double target_error, unsigned int random_seed) const
+{
+    if (current_size == 0)
+    {
+        error = 0.0;
+        return 0.0;
+    }
+    return wedge_sampling(vector<double>(), -1, vector<unsigned int>(), error, max_samples, target_error, random_seed);
+}
+
+
+/** \brief Estimates the clustering coefficient of a single node
+*  \param node_index: target node
+*  \param[out] error: half-width of the 95% confidence interval of the estimation
+*  \param max_samples: optional. Maximum number of pairs of neighbours to sample. Default: 10^4.
+*  \param target_error: optional. If positive, stop sampling when error is below this value.
+*  \param random_seed: optional, default 123456789.
+*  \return estimated clustering coefficient of the node
+*
+* Samples random pairs of neighbours of the node and checks if they are linked. Useful for hubs, where
+* the exact computation needs to check all the pairs of neighbours.
+*/
+template <class T, typename B>
+double DirectedCNetwork<T,B>::approx_clustering_coef(int node_index, double &error, int max_samples, double target_error, unsigned int random_seed) const
+{
+    vector<unsigned int> clean;
+
+    //Clean list of neighbours of the node only
+    clean.assign(neighs[node_index].begin(), neighs[node_index].end());
+    if (node_index < (int)pointing_in.size()) clean.insert(clean.end(), pointing_in[node_index].begin(), pointing_in[node_index].end());
+    sort(clean.begin(), clean.end());
+    clean.erase(unique(clean.begin(), clean.end()), clean.end());
+    clean.erase(remove(clean.begin(), clean.end(), (unsigned int)node_index), clean.end());
+
+    return wedge_sampling(vector<double>(), node_index, clean, error, max_samples, target_error, random_seed);
+}
+
+
+/** \brief Computes the degree distribution of the network
+*  \param[out] distribution: index j contains number of nodes with degree j. It is the degree distribution
+*  \param type: kind of average to take: IN_DEGREE, OUT_DEGREE, or TOTAL_DEGREE
+*
+* Compute the degree distribution of the network. If you also need the correlations, please use instead degree_correlation.
+* For the normalized distribution, pass a vector of doubles.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::degree_distribution(vector<int> &distribution, int type) const
+{
+    int i;
+    distribution = vector<int>(current_size, 0);
+
+    //Select in, out, or full degree distribution and compute it:
+    if (type == 0) for (i=0; i < current_size; i++) distribution[in_degree(i)] += 1;
+    else if (type == 1) for (i=0; i < current_size; i++) distribution[out_degree(i)] += 1;
+    else for (i=0; i < current_size; i++) distribution[degree(i)] += 1;
+
+    //Erase the 0s at the end of the array.
+    i = current_size - 1; //Start counter
+    while (distribution[i] == 0)
+    {
+        //distribution.erase(distribution.begin() + i);
+        distribution.pop_back();
+        i -= 1;
+    }
+
+    return;
+}
+
+
+/** \brief Computes the normalized degree distribution of the network
+*  \param[out] distribution: index j contains the fraction of nodes with degree j
+*  \param type: kind of average to take: IN_DEGREE, OUT_DEGREE, or TOTAL_DEGREE
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::degree_distribution(vector<double> &distribution, int type) const
+{
+    int i;
+    vector<int> counts;
+
+    degree_distribution(counts, type);
+    distribution = vector<double>(counts.size());
+    for (i=0; i < (int)counts.size(); i++) distribution[i] = counts[i] / (1.0 * current_size);
+
+    return;
+}
+
+
+/** \brief Computes the degree distribution and correlations
+*  \param[out] distribution: index j contains number of nodes with degree j. It is the degree distribution
+*  \param[out] correlation: index j contains average degree of neighbours of a node with degree j
+*  \param type: kind of average to take: IN_DEGREE, OUT_DEGREE, or TOTAL_DEGREE
+*
+* Computes the average number of neighbours that a node with degree j has. It also computes and stores the degree distribution,
+* since both quantities are usually needed. If more statistics are needed, use degree_statistics, which computes all of them at once.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::degree_correlation(vector<int> &distribution, vector<double> &correlation, int type) const
+{
+    vector<int> in_dist, out_dist, total_dist;
+    double mean_k, mean_k2, assortativity;
+
+    degree_statistics(in_dist, out_dist, total_dist, correlation, mean_k, mean_k2, assortativity, type);
+
+    //Select the distribution of the kind of degree asked
+    if (type == IN_DEGREE) distribution = in_dist;
+    else if (type == OUT_DEGREE) distribution = out_dist;
+    else distribution = total_dist;
+
+    return;
+}
+
+
+/** \brief Computes all the degree statistics in a single pass over the network
+*  \param[out] in_distribution: index j contains number of nodes with in-degree j
+*  \param[out] out_distribution: index j contains number of nodes with out-degree j
+*  \param[out] distribution: index j contains number of nodes with total degree j
+*  \param[out] correlation: index j contains average degree of neighbours of a node with degree j. It is k_nn(k)
+*  \param[out] mean_k: average degree
+*  \param[out] mean_k2: average of the squared degree
+*  \param[out] assortativity: Newman's assortativity coefficient
+*  \param type: optional. Kind of degree used for moments, correlation and assortativity: IN_DEGREE, OUT_DEGREE or TOTAL_DEGREE (default).
+*
+* Computes the three degree histograms, the first two moments, k_nn(k) and the assortativity, visiting each node and link
+* only once. For IN_DEGREE the neighbours are the nodes pointing to the node, for OUT_DEGREE the nodes it points to, and for
+* TOTAL_DEGREE both of them. Assortativity is the Pearson correlation between the degrees at both ends of each link, which is
+* Newman's coefficient for undirected networks. Each thread fills its own histograms when compiled with OpenMP.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::degree_statistics(vector<int> &in_distribution, vector<int> &out_distribution, vector<int> &distribution,
+                                              vector<double> &correlation, double &mean_k, double &mean_k2, double &assortativity, int type) const
+{
+    int i,j;
+
+    //Sums needed for moments and assortativity
+    double sum_k, sum_k2;
+    double sum_x, sum_y, sum_x2, sum_y2, sum_xy, n_links;
+
+    in_distribution = vector<int>();
+    out_distribution = vector<int>();
+    distribution = vector<int>();
+    correlation = vector<double>();
+    vector<int> knn_count; //Nodes with degree k and at least one neighbour
+
+    sum_k = sum_k2 = 0.0;
+    sum_x = sum_y = sum_x2 = sum_y2 = sum_xy = n_links = 0.0;
+
+    #pragma omp parallel private(j)
+    {
+        //Histograms of each thread, which grow when needed
+        vector<int> local_in, local_out, local_total, local_count;
+        vector<double> local_knn;
+        int k, kin, kout, ktype;
+        int neigh;
+        double knn;
+
+        #pragma omp for schedule(dynamic, 1024) reduction(+:sum_k,sum_k2,sum_x,sum_y,sum_x2,sum_y2,sum_xy,n_links)
+        for (i=0; i < current_size; i++)
+        {
+            //Undirected networks only use neighs
+            kout = neighs[i].size();
+            kin = directed ? pointing_in[i].size() : kout;
+            k = directed ? kin + kout : kout;
+            ktype = type == IN_DEGREE ? kin : (type == OUT_DEGREE ? kout : k);
+
+            if (kin >= (int)local_in.size()) local_in.resize(kin+1, 0);
+            if (kout >= (int)local_out.size()) local_out.resize(kout+1, 0);
+            if (k >= (int)local_total.size()) local_total.resize(k+1, 0);
+            if (ktype >= (int)local_knn.size())
+            {
+                local_knn.resize(ktype+1, 0.0);
+                local_count.resize(ktype+1, 0);
+            }
+            local_in[kin] += 1;
+            local_out[kout] += 1;
+            local_total[k] += 1;
+
+            sum_k += ktype;
+            sum_k2 += 1.0 * ktype * ktype;
+
+            //Degree of the neighbours, in the sense given by type
+            knn = 0.0;
+            if (type != IN_DEGREE or not directed)
+            {
+                for (j=0; j < kout; j++)
+                {
+                    neigh = neighs[i][j];
+                    knn += neigh_degree(neigh, type);
+                }
+            }
+            if (directed and type != OUT_DEGREE)
+            {
+                for (j=0; j < kin; j++)
+                {
+                    neigh = pointing_in[i][j];
+                    knn += neigh_degree(neigh, type);
+                }
+            }
+            if (ktype > 0)
+            {
+                local_knn[ktype] += knn / ktype;
+                local_count[ktype] += 1;
+            }
+
+            //Assortativity is computed over the links going out from i
+            for (j=0; j < kout; j++)
+            {
+                double y = neigh_degree(neighs[i][j], type);
+                sum_x += ktype;
+                sum_y += y;
+                sum_x2 += 1.0 * ktype * ktype;
+                sum_y2 += y * y;
+                sum_xy += ktype * y;
+                n_links += 1.0;
+            }
+        }
+
+        //Merge the histograms of all the threads
+        #pragma omp critical
+        {
+            if (local_in.size() > in_distribution.size()) in_distribution.resize(local_in.size(), 0);
+            if (local_out.size() > out_distribution.size()) out_distribution.resize(local_out.size(), 0);
+            if (local_total.size() > distribution.size()) distribution.resize(local_total.size(), 0);
+            if (local_knn.size() > correlation.size())
+            {
+                correlation.resize(local_knn.size(), 0.0);
+                knn_count.resize(local_knn.size(), 0);
+            }
+            for (j=0; j < (int)local_in.size(); j++) in_distribution[j] += local_in[j];
+            for (j=0; j < (int)local_out.size(); j++) out_distribution[j] += local_out[j];
+            for (j=0; j < (int)local_total.size(); j++) distribution[j] += local_total[j];
+            for (j=0; j < (int)local_knn.size(); j++)
+            {
+                correlation[j] += local_knn[j];
+                knn_count[j] += local_count[j];
+            }
+        }
+    }
+
+    //Finish averages
+    for (i=0; i < (int)correlation.size(); i++)
+    {
+        if (knn_count[i] != 0) correlation[i] /= 1.0*knn_count[i];
+    }
+
+    mean_k = current_size > 0 ? sum_k / current_size : 0.0;
+    mean_k2 = current_size > 0 ? sum_k2 / current_size : 0.0;
+
+    if (n_links > 0.0)
+    {
+        double cov = sum_xy / n_links - (sum_x / n_links) * (sum_y / n_links);
+        double var_x = sum_x2 / n_links - (sum_x / n_links) * (sum_x / n_links);
+        double var_y = sum_y2 / n_links - (sum_y / n_links) * (sum_y / n_links);
+        assortativity = (var_x > 0.0 and var_y > 0.0) ? cov / sqrt(var_x * var_y) : 0.0;
+    }
+    else assortativity = 0.0;
+
+    return;
+}
+
+
+/** \brief Degree of a node, of the kind selected
+*  \param node_index: target node
+*  \param type: IN_DEGREE, OUT_DEGREE, or TOTAL_DEGREE
+*  \return degree of the node
+*
+* Reads the degree directly from the lists, so it works both for directed and undirected networks.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::neigh_degree(int node_index, int type) const
+{
+    if (not directed) return neighs[node_index].size();
+    else if (type == IN_DEGREE) return pointing_in[node_index].size();
+    else if (type == OUT_DEGREE) return neighs[node_index].size();
+    else return neighs[node_index].size() + pointing_in[node_index].size();
+}
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+
+/** \brief Generates a random Erdos-Renyi network
+*  \param nodes: nodes of the network
+*  \param mean_k: average degree
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Generates an Erdos-Renyi network, where each pair of nodes is linked with probability p = mean_k/(nodes-1). In
+* directed networks, the direction of each link is chosen at random. The random seed should be specified for obtaining
+* different networks each iteration.
+* Uses the geometric skipping of Batagelj and Brandes: the gap to the next linked pair follows a geometric distribution,
+* so the cost is O(N + E) instead of O(N^2). Pairs are split in a fixed number of blocks with their own random streams,
+* generated in parallel, so the network is the same for any number of threads. Links are added with add_links.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_erdos_renyi(int n, double mean_k, unsigned int random_seed)
+{
+    int b, first, n_blocks;
+    double p;
+    unsigned long long n_pairs;
+
+    vector<unsigned int> block_start;
+    vector< vector< pair<unsigned int, unsigned int> > > block_links;
+    vector< pair<unsigned int, unsigned int> > links;
+
+    first = current_size;
+    add_nodes(n); //Create the nodes
+    n = current_size - first;
+    if (n < 2) return;
+
+    p = mean_k / (n - 1.0);
+    n_pairs = (unsigned long long)n * (n - 1) / 2;
+
+    //Blocks of rows with about the same number of pairs. Row v has v pairs (v,w) with w < v
+    n_blocks = min(n, 256);
+    block_start = vector<unsigned int>(n_blocks+1, n);
+    block_start[0] = 1;
+    for (b=1; b < n_blocks; b++)
+    {
+        unsigned int i, j;
+        pair_from_index(n_pairs / n_blocks * b, i, j);
+        block_start[b] = max(i, block_start[b-1]);
+    }
+
+    block_links = vector< vector< pair<unsigned int, unsigned int> > >(n_blocks);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (b=0; b < n_blocks; b++)
+    {
+        rng_stream gen(random_seed, b);
+        long long v = block_start[b];
+        long long w = -1;
+        long long end = block_start[b+1];
+        double log_q = log1p(-p); //Accurate also for very small p
+
+        if (p <= 0.0) continue;
+
+        vector< pair<unsigned int, unsigned int> > &local = block_links[b];
+        local.reserve(p * ((double)end * (end - 1) - (double)v * (v - 1)) / 2.0 * 1.05 + 16);
+
+        while (v < end)
+        {
+            //Skip a geometric number of pairs. Skips longer than the block, or infinite, finish it
+            if (p >= 1.0) w += 1;
+            else
+            {
+                double skip = floor(log1p(-gen.uniform()) / log_q);
+                if (skip >= (double)end * end) break;
+                w += 1 + (long long)skip;
+            }
+
+            while (w >= v and v < end)
+            {
+                w -= v;
+                v += 1;
+            }
+            if (v < end)
+            {
+                if (directed and gen.below(2) == 1) local.push_back(make_pair(first + w, first + v));
+                else local.push_back(make_pair(first + v, first + w));
+            }
+        }
+    }
+
+    //Join the blocks in order
+    size_t total = 0;
+    for (b=0; b < n_blocks; b++) total += block_links[b].size();
+    links.reserve(total);
+    for (b=0; b < n_blocks; b++)
+    {
+        links.insert(links.end(), block_links[b].begin(), block_links[b].end());
+        vector< pair<unsigned int, unsigned int> >().swap(block_links[b]);
+    }
+
+    add_links(links);
+
+    return;
+}
+
+
+/** \brief Generates a random network with a fixed number of links
+*  \param nodes: nodes of the network
+*  \param n_links: number of links. It is reduced to the number of pairs if it is larger.
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Erdos-Renyi G(N, M) model: n_links different pairs chosen uniformly. In directed networks the direction of each link
+* is chosen at random. Candidate pairs are drawn in parallel, each one from its own random stream, and accepted in order
+* if they were not chosen before, checked with a hash set, so the network is the same for any number of threads.
+* If more than half of the pairs are needed, the pairs left out are chosen instead. Cost is O(N + M).
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_erdos_renyi_links(int n, long long n_links, unsigned int random_seed)
+{
+    long long i, drawn, needed;
+    int first;
+    bool complement;
+    unsigned int x, y;
+    unsigned long long n_pairs;
+
+    vector<unsigned long long> candidates;
+    vector< pair<unsigned int, unsigned int> > links;
+
+    first = current_size;
+    add_nodes(n);
+    n = current_size - first;
+    if (n < 2) return;
+
+    n_pairs = (unsigned long long)n * (n - 1) / 2;
+    if (n_links > (long long)n_pairs) n_links = n_pairs;
+
+    complement = n_links > (long long)(n_pairs / 2);
+    needed = complement ? n_pairs - n_links : n_links;
+
+    link_set chosen(needed);
+    vector<unsigned long long> accepted;
+    accepted.reserve(needed);
+
+    drawn = 0;
+    while ((long long)accepted.size() < needed)
+    {
+        long long batch = needed - accepted.size();
+        candidates = vector<unsigned long long>(batch);
+
+        #pragma omp parallel for schedule(static)
+        for (i=0; i < batch; i++)
+        {
+            rng_stream gen(random_seed, drawn + i);
+            candidates[i] = gen.below(n_pairs);
+        }
+        drawn += batch;
+
+        for (i=0; i < batch and (long long)accepted.size() < needed; i++)
+        {
+            if (not chosen.contains(candidates[i]))
+            {
+                chosen.insert(candidates[i]);
+                accepted.push_back(candidates[i]);
+            }
+        }
+    }
+
+    if (complement)
+    {
+        //Take all the pairs not chosen, in order
+        sort(accepted.begin(), accepted.end());
+        accepted.push_back(n_pairs);
+        vector<unsigned long long> kept;
+        kept.reserve(n_links);
+        unsigned long long next = 0;
+        for (i=0; i < (long long)accepted.size(); i++)
+        {
+            for (; next < accepted[i]; next++) kept.push_back(next);
+            next = accepted[i] + 1;
+        }
+        accepted.swap(kept);
+    }
+
+    links = vector< pair<unsigned int, unsigned int> >(accepted.size());
+
+    #pragma omp parallel for schedule(static) private(x, y)
+    for (i=0; i < (long long)accepted.size(); i++)
+    {
+        pair_from_index(accepted[i], x, y);
+        rng_stream gen(random_seed ^ 0x5851F42D4C957F2DULL, i);
+        if (directed and gen.below(2) == 1) links[i] = make_pair(first + y, first + x);
+        else links[i] = make_pair(first + x, first + y);
+    }
+
+    add_links(links);
+
+    return;
+}
+
+
+/** \brief Gets the pair of nodes with the given index
+*  \param index: index of the pair, between 0 and N(N-1)/2 - 1
+*  \param[out] i, j: nodes of the pair, with i > j
+*
+* Pairs are sorted as (1,0), (2,0), (2,1), (3,0)... so pair (i,j) has index i(i-1)/2 + j.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::pair_from_index(unsigned long long index, unsigned int &i, unsigned int &j) const
+{
+    unsigned long long row = (1.0 + sqrt(1.0 + 8.0 * index)) / 2.0;
+
+    //Fix rounding errors of the square root
+    while (row * (row - 1) / 2 > index) row -= 1;
+    while ((row + 1) * row / 2 <= index) row += 1;
+
+    i = row;
+    j = index - row * (row - 1) / 2;
+    return;
+}
+
+
+
+/** \brief Generates a R-MAT network, as the Kronecker graphs of the Graph500 benchmark
+*  \param scale: the network has 2^scale nodes
+*  \param edge_factor: optional, default 16. Number of links per node.
+*  \param a, b, c: optional, default 0.57, 0.19, 0.19 as in Graph500. Probability of each quarter of the adjacency
+*  matrix in the recursion; the last one has d = 1 - a - b - c.
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Each link chooses, scale times, one quarter of the adjacency matrix, which gives one bit of each end. Link e uses
+* its own random stream, so links are generated in parallel and do not depend on the number of threads. Nodes are
+* randomly relabelled, so degree is not related to the index. As in Graph500, self-loops and repeated links are kept.
+* Links are added with add_links; use write_rmat for networks that do not fit in memory.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_rmat(int scale, int edge_factor, double a, double b, double c, unsigned int random_seed)
+{
+    int first, n;
+    long long n_links;
+
+    vector< pair<unsigned int, unsigned int> > links;
+
+    n = 1 << scale;
+    first = current_size;
+    add_nodes(n);
+    if (current_size - first < n)
+    {
+        cout << "WARNING [DirectedCNetwork]: not enough space for 2^scale nodes. No links added." << endl;
+        return;
+    }
+
+    n_links = (long long)edge_factor * n;
+    links = vector< pair<unsigned int, unsigned int> >(n_links);
+    rmat_edges(0, n_links, scale, a, b, c, random_seed, first, links.data());
+
+    add_links(links);
+
+    return;
+}
+
+
+/** \brief Writes a R-MAT network directly to a MTX file
+*  \param filename: name of the file (without extension)
+*  \param scale, edge_factor, a, b, c, random_seed: as in create_rmat
+*  \return number of links written
+*
+* Same network as create_rmat on an empty network, written in the format of write_mtx without storing it, so it
+* only needs memory for one block of links. Blocks are generated and formatted in parallel.
+*/
+template <class T, typename B>
+long long DirectedCNetwork<T,B>::write_rmat(string filename, int scale, int edge_factor, double a, double b, double c, unsigned int random_seed) const
+{
+    const long long block = 1 << 22;
+    const int n_pieces = 64;
+    int t;
+    long long n, n_links, start, end;
+
+    vector< pair<unsigned int, unsigned int> > links;
+    vector<string> text;
+    ofstream output;
+
+    n = 1LL << scale;
+    n_links = edge_factor * n;
+
+    output.open(filename + ".mtx");
+    output << "%Network created using DirectedCNetwork 1.0" << endl;
+    output << n << " " << n << " " << n_links << endl;
+
+    links = vector< pair<unsigned int, unsigned int> >(block);
+    text = vector<string>(n_pieces);
+
+    for (start=0; start < n_links; start += block)
+    {
+        end = min(start + block, n_links);
+        rmat_edges(start, end, scale, a, b, c, random_seed, 0, links.data());
+
+        //Pieces of the block are formatted in parallel and written in order
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (t=0; t < n_pieces; t++)
+        {
+            long long l;
+            long long from = (end - start) * t / n_pieces;
+            long long to = (end - start) * (t + 1) / n_pieces;
+            char line[24];
+            int length;
+            string &piece = text[t];
+
+            //Digits are written backwards from the end of the line, which is faster than formatted output
+            auto write_number = [&](unsigned int x)
+            {
+                do
+                {
+                    line[--length] = '0' + x % 10;
+                    x /= 10;
+                }
+                while (x > 0);
+            };
+
+            piece.clear();
+            piece.reserve((to - from) * 16);
+            for (l=from; l < to; l++)
+            {
+                length = sizeof(line);
+                line[--length] = '\n';
+                write_number(links[l].second);
+                line[--length] = ' ';
+                write_number(links[l].first);
+                piece.append(line + length, sizeof(line) - length);
+            }
+        }
+        for (t=0; t < n_pieces; t++) output.write(text[t].data(), text[t].size());
+    }
+
+    output.close();
+
+    return n_links;
+}
+
+
+/** \brief Generates a range of R-MAT links
+*  \param begin, end: indices of the links to generate
+*  \param scale, a, b, c, random_seed: as in create_rmat
+*  \param first: index of the first node
+*  \param[out] edges: link begin+l is stored in edges[l]
+*
+* Quarters are chosen comparing 32 random bits with the cumulative probabilities, so each 64 bit draw gives two levels.
+* Nodes are relabelled with a random bijection of scale bits (products by odd numbers and xor-shifts), computed on the
+* fly instead of a permutation table, which would need a cache miss for each end.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::rmat_edges(long long begin, long long end, int scale, double a, double b, double c, unsigned int random_seed,
+                                       unsigned int first, pair<unsigned int, unsigned int> *edges) const
+{
+    long long e;
+    const double range = 4294967296.0;
+    const unsigned long long mask = (1ULL << scale) - 1;
+    const int shift = (scale + 1) / 2;
+    const unsigned long long factor_1 = rng_stream::mix(random_seed + 1ULL) | 1ULL;
+    const unsigned long long factor_2 = rng_stream::mix(random_seed + 2ULL) | 1ULL;
+    const unsigned long long offset = rng_stream::mix(random_seed + 3ULL);
+
+    //Random relabelling of the nodes
+    auto relabel = [&](unsigned long long x) -> unsigned int
+    {
+        x = (x * factor_1 + offset) & mask;
+        x ^= x >> shift;
+        x = (x * factor_2) & mask;
+        x ^= x >> shift;
+        x = (x * factor_1) & mask;
+        return first + x;
+    };
+    const unsigned long long limit_a = a * range;
+    const unsigned long long limit_b = (a + b) * range;
+    const unsigned long long limit_c = (a + b + c) * range;
+
+    #pragma omp parallel for schedule(static)
+    for (e=begin; e < end; e++)
+    {
+        rng_stream gen(random_seed, e);
+        unsigned int row = 0, column = 0;
+        unsigned long long bits = 0, u;
+        int level;
+
+        for (level=0; level < scale; level++)
+        {
+            if (level % 2 == 0) bits = gen();
+            u = bits & 0xFFFFFFFFULL;
+            bits >>= 32;
+
+            //Without branches, since the choice is unpredictable
+            row = (row << 1) | (u >= limit_b);
+            column = (column << 1) | ((u >= limit_a and u < limit_b) or u >= limit_c);
+        }
+        edges[e - begin] = make_pair(relabel(row), relabel(column));
+    }
+
+    return;
+}
+
+
+
+/** \brief Generates a scale-free network using the configurational model
+*  \param nodes: nodes of the network
+*  \param kmin: minimum degree of each node
+*  \param gamma: exponent of power law
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Generates a scale free network based using the configuration model, with degrees up to sqrt(N) to avoid
+* correlations. Self-loops and multi-links are erased, see create_configuration_model. The random seed should be
+* specified for obtaining different networks each iteration.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_configurational(int n, int mink, double gamma, unsigned int random_seed)
+{
+    int i;
+    int max_size; //Maximum size if we want an uncorrelated network
+
+    vector<int> node_degree;
+
+    mt19937 gen(random_seed); //Create the generator
+    uniform_real_distribution<double> ran_u(0.0,1.0); //Uniform number distribution
+
+    node_degree = vector<int>(n); //Store degree of every node
+    max_size = sqrt(n); //Max size to avoid correlatons
+
+    //Compute all the quantities we need to generate the degrees,
+    double kmax = pow(max_size, 1.0-gamma);
+    double kmin = pow(mink, 1.0-gamma);
+    double invgamma = 1.0 / (1.0 - gamma);
+
+    for (i=0; i < n; i++)
+    {
+        node_degree[i] = floor( pow( ran_u(gen)*(kmax - kmin) + kmin, invgamma ) ); //Generate degrees
+    }
+
+    create_configuration_model(node_degree, ERASED, random_seed);
+
+    return;
+}
+
+
+/** \brief Generates a network with the given degrees using the configuration model
+*  \param degrees: degree of each new node. If the sum is odd, node 0 gets one more link.
+*  \param simple: optional, default ERASED. What to do with self-loops and multi-links. MULTIGRAPH keeps them,
+*  ERASED removes them, so some nodes lose a few links, and SWITCHING rewires them with double edge swaps until the
+*  network is simple, keeping all the degrees.
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* The stubs (link ends) are shuffled in parallel and joined in pairs, with cost O(N + E). In directed networks the
+* direction of each link is random; use the version with in and out degrees to fix them.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_configuration_model(const vector<int> &degrees, int simple, unsigned int random_seed)
+{
+    long long i, j, n_stubs;
+    int first, n;
+
+    vector<long long> offset;
+    vector<unsigned int> stubs, out_stubs, in_stubs;
+
+    first = current_size;
+    add_nodes(degrees.size());
+    n = current_size - first;
+
+    if (n == 0) return;
+
+    offset = vector<long long>(n+1, 0);
+    for (i=0; i < n; i++) offset[i+1] = offset[i] + degrees[i];
+    if (offset[n] % 2 == 1)
+    {
+        for (i=1; i <= n; i++) offset[i] += 1; //The extra stub goes to node 0
+    }
+    n_stubs = offset[n];
+
+    stubs = vector<unsigned int>(n_stubs);
+    #pragma omp parallel for schedule(dynamic, 1024) private(j)
+    for (i=0; i < n; i++)
+    {
+        for (j = offset[i]; j < offset[i+1]; j++) stubs[j] = i;
+    }
+
+    parallel_shuffle(stubs, random_seed);
+
+    //Pairs of consecutive stubs are the links
+    out_stubs = vector<unsigned int>(n_stubs / 2);
+    in_stubs = vector<unsigned int>(n_stubs / 2);
+    #pragma omp parallel for schedule(static)
+    for (i=0; i < n_stubs / 2; i++)
+    {
+        out_stubs[i] = stubs[2*i];
+        in_stubs[i] = stubs[2*i+1];
+    }
+    vector<unsigned int>().swap(stubs);
+
+    match_stubs(out_stubs, in_stubs, first, simple, random_seed);
+
+    return;
+}
+
+
+/** \brief Generates a directed network with the given in and out degrees using the configuration model
+*  \param out_degrees: out-degree of each new node
+*  \param in_degrees: in-degree of each new node. Both sequences must have the same size and sum.
+*  \param simple: optional, default ERASED. MULTIGRAPH, ERASED or SWITCHING, as in the undirected version.
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Out-stubs are kept in order and in-stubs shuffled in parallel, so each link joins one of each. Only for directed
+* networks.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_configuration_model(const vector<int> &out_degrees, const vector<int> &in_degrees, int simple, unsigned int random_seed)
+{
+    long long i, j, n_stubs, sum_in;
+    int first, n;
+
+    vector<long long> offset, offset_in;
+    vector<unsigned int> out_stubs, in_stubs;
+
+    if (not directed)
+    {
+        cout << "WARNING [DirectedCNetwork]: in and out degrees need a directed network. Nothing done." << endl;
+        return;
+    }
+
+    n = out_degrees.size();
+    sum_in = 0;
+    for (i=0; i < (long long)in_degrees.size(); i++) sum_in += in_degrees[i];
+    offset = vector<long long>(n+1, 0);
+    for (i=0; i < n; i++) offset[i+1] = offset[i] + out_degrees[i];
+    if ((int)in_degrees.size() != n or sum_in != offset[n])
+    {
+        cout << "WARNING [DirectedCNetwork]: in and out degrees must have the same size and sum. Nothing done." << endl;
+        return;
+    }
+
+    first = current_size;
+    add_nodes(n);
+    if (current_size - first < n)
+    {
+        cout << "WARNING [DirectedCNetwork]: not enough space for the nodes. Nothing done." << endl;
+        return;
+    }
+
+    n_stubs = offset[n];
+    offset_in = vector<long long>(n+1, 0);
+    for (i=0; i < n; i++) offset_in[i+1] = offset_in[i] + in_degrees[i];
+
+    out_stubs = vector<unsigned int>(n_stubs);
+    in_stubs = vector<unsigned int>(n_stubs);
+    #pragma omp parallel for schedule(dynamic, 1024) private(j)
+    for (i=0; i < n; i++)
+    {
+        for (j = offset[i]; j < offset[i+1]; j++) out_stubs[j] = i;
+        for (j = offset_in[i]; j < offset_in[i+1]; j++) in_stubs[j] = i;
+    }
+
+    parallel_shuffle(in_stubs, random_seed);
+
+    match_stubs(out_stubs, in_stubs, first, simple, random_seed);
+
+    return;
+}
+
+
+/** \brief Builds the links of the configuration model from the matched stubs
+*  \param out_stubs, in_stubs: link i goes from out_stubs[i] to in_stubs[i]. in_stubs is changed.
+*  \param first: index of the first new node
+*  \param simple: MULTIGRAPH, ERASED or SWITCHING
+*  \param random_seed: seed for the switchings
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::match_stubs(const vector<unsigned int> &out_stubs, vector<unsigned int> &in_stubs, int first, int simple, unsigned int random_seed)
+{
+    long long i, n_links;
+    unsigned long long k;
+
+    vector<unsigned int> from;
+    vector< pair<unsigned int, unsigned int> > links;
+
+    n_links = out_stubs.size();
+
+    links.reserve(n_links);
+    if (simple == ERASED)
+    {
+        link_set existing(n_links);
+        for (i=0; i < n_links; i++)
+        {
+            if (out_stubs[i] == in_stubs[i]) continue;
+            if (not directed and in_stubs[i] < out_stubs[i]) k = ((unsigned long long)in_stubs[i] << 32) | out_stubs[i];
+            else k = ((unsigned long long)out_stubs[i] << 32) | in_stubs[i];
+            if (existing.contains(k)) continue;
+            existing.insert(k);
+            links.push_back(make_pair(first + out_stubs[i], first + in_stubs[i]));
+        }
+    }
+    else
+    {
+        //Switchings already give a simple network, so all the links are kept
+        if (simple == SWITCHING)
+        {
+            from = out_stubs;
+            rng_stream gen(random_seed, 0x5357495443484553ULL);
+            long long left = repair_links(from, in_stubs, gen);
+            if (left > 0) cout << "WARNING [DirectedCNetwork]: " << left << " self-loops or multi-links could not be switched and were erased." << endl;
+        }
+        const vector<unsigned int> &source = simple == SWITCHING ? from : out_stubs;
+
+        links.resize(source.size());
+        #pragma omp parallel for schedule(static)
+        for (i=0; i < (long long)source.size(); i++) links[i] = make_pair(first + source[i], first + in_stubs[i]);
+    }
+
+    add_links(links);
+
+    return;
+}
+
+
+/** \brief Removes self-loops and multi-links with double edge swaps
+*  \param from, to: ends of each link, changed in place
+*  \param gen: random stream
+*  \param group: optional. If given, links between nodes of the same group are also bad.
+*  \return number of bad links that could not be repaired and were erased
+*
+* Each self-loop or repeated link is swapped with a random link, if the two new links are not self-loops or already
+* there (or inside a group), so all degrees are kept. Bad links are usually few, and the repair has a bounded number of rounds in case
+* the degree sequence can not be made simple. Links still bad after that are removed from the lists.
+*/
+template <class T, typename B>
+long long DirectedCNetwork<T,B>::repair_links(vector<unsigned int> &from, vector<unsigned int> &to, rng_stream &gen, const vector<int> &group) const
+{
+    long long i, e, f, n, tries;
+    int round;
+    unsigned int a, b, c, d;
+    unsigned long long key_ad, key_cb;
+
+    vector<long long> bad, still_bad;
+
+    n = from.size();
+    link_set existing(n);
+
+    auto key = [this](unsigned int x, unsigned int y) -> unsigned long long
+    {
+        if (not directed and y < x) swap(x, y);
+        return ((unsigned long long)x << 32) | y;
+    };
+    auto is_bad = [&](long long l) -> bool
+    {
+        if (group.size() > 0 and group[from[l]] == group[to[l]]) return true;
+        return from[l] == to[l] or existing.counts[existing.find(key(from[l], to[l]))] > 1;
+    };
+
+    for (i=0; i < n; i++) existing.insert(key(from[i], to[i]));
+    for (i=0; i < n; i++) if (is_bad(i)) bad.push_back(i);
+
+    for (round=0; round < 10 and bad.size() > 0; round++)
+    {
+        still_bad.clear();
+        for (i=0; i < (long long)bad.size(); i++)
+        {
+            e = bad[i];
+            for (tries = 0; tries < 100 and is_bad(e); tries++)
+            {
+                f = gen.below(n);
+                if (f == e) continue;
+
+                a = from[e];
+                b = to[e];
+                c = from[f];
+                d = to[f];
+                if (not directed and gen.below(2) == 1) swap(c, d);
+
+                if (a == d or c == b) continue;
+                if (group.size() > 0 and (group[a] == group[d] or group[c] == group[b])) continue;
+                key_ad = key(a, d);
+                key_cb = key(c, b);
+                if (key_ad == key_cb or existing.contains(key_ad) or existing.contains(key_cb)) continue;
+
+                existing.erase(key(from[e], to[e]));
+                existing.erase(key(from[f], to[f]));
+                existing.insert(key_ad);
+                existing.insert(key_cb);
+
+                to[e] = d;
+                from[f] = c;
+                to[f] = b;
+            }
+            if (is_bad(e)) still_bad.push_back(e);
+        }
+        bad.swap(still_bad);
+    }
+
+    //Erase what is left, keeping one copy of each multi-link
+    vector<bool> erased(n, false);
+    for (i=0; i < (long long)bad.size(); i++)
+    {
+        e = bad[i];
+        if (is_bad(e))
+        {
+            existing.erase(key(from[e], to[e]));
+            erased[e] = true;
+        }
+    }
+    f = 0;
+    for (i=0; i < n; i++)
+    {
+        if (erased[i]) continue;
+        from[f] = from[i];
+        to[f] = to[i];
+        f++;
+    }
+    from.resize(f);
+    to.resize(f);
+
+    return n - f;
+}
+
+
+
+/** \brief Generates a degree-corrected stochastic block model
+*  \param block_sizes: number of nodes of each block. New nodes are given to the blocks in order.
+*  \param probability: probability[r][s] is the probability of a link between nodes of blocks r and s. For undirected
+*  networks it should be symmetric, and only r <= s is used.
+*  \param propensity: optional. Degree correction theta of each new node. Nodes i and j are linked with probability
+*  min(1, theta_i theta_j probability[r][s]), so if theta averages 1 inside each block the expected number of links
+*  between blocks is not changed. If empty, every theta is 1 and this is the usual stochastic block model. A vector of
+*  wrong size gives a warning, and every theta is 1 too.
+*  \param property: optional, default "block". Name of the int node property where the block of each node is stored.
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Nodes of each block are sorted by decreasing theta, so for a fixed node the probability decreases along the block,
+* and the next link is found with geometric skipping plus an acceptance test, as Miller and Hagberg do for the
+* Chung-Lu model. The cost is O(N B + E) for B blocks. Nodes are processed in parallel in fixed chunks with their own
+* random streams, so the network does not depend on the number of threads. In directed networks every ordered pair
+* is considered.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_sbm(const vector<int> &block_sizes, const vector< vector<double> > &probability, const vector<double> &propensity,
+                                       string property, unsigned int random_seed)
+{
+    const int chunk = 1024;
+    int i, r, first, n, n_blocks, n_chunks, c;
+
+    vector<int> block_start, membership;
+    vector<unsigned int> order;
+    vector<double> theta;
+    vector< vector< pair<unsigned int, unsigned int> > > chunk_links;
+    vector< pair<unsigned int, unsigned int> > links;
+
+    n_blocks = block_sizes.size();
+    block_start = vector<int>(n_blocks+1, 0);
+    for (r=0; r < n_blocks; r++) block_start[r+1] = block_start[r] + block_sizes[r];
+    n = block_start[n_blocks];
+
+    //A propensity of wrong size is ignored, as an uncorrected model
+    bool corrected = (int)propensity.size() == n;
+    if (propensity.size() > 0 and not corrected)
+    {
+        cout << "WARNING [DirectedCNetwork]: propensity vector has " << propensity.size() << " elements for "
+             << n << " nodes. Using theta = 1 for all the nodes." << endl;
+    }
+
+    first = current_size;
+    add_nodes(n);
+    if (current_size - first < n)
+    {
+        cout << "WARNING [DirectedCNetwork]: not enough space for the nodes. No links added." << endl;
+        return;
+    }
+
+    membership = vector<int>(n);
+    theta = vector<double>(n, 1.0);
+    order = vector<unsigned int>(n);
+    for (r=0; r < n_blocks; r++)
+    {
+        for (i=block_start[r]; i < block_start[r+1]; i++)
+        {
+            membership[i] = r;
+            order[i] = i;
+            if (corrected) theta[i] = propensity[i];
+        }
+        //Decreasing theta inside each block
+        stable_sort(order.begin() + block_start[r], order.begin() + block_start[r+1],
+                    [&theta](unsigned int x, unsigned int y) {return theta[x] > theta[y];});
+    }
+
+    n_chunks = (n + chunk - 1) / chunk;
+    chunk_links = vector< vector< pair<unsigned int, unsigned int> > >(n_chunks);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (c=0; c < n_chunks; c++)
+    {
+        rng_stream gen(random_seed, c);
+        long long a, b, end;
+        int s, t;
+        unsigned int u, v;
+        double p, q, pr;
+
+        for (a = (long long)c * chunk; a < min((long long)(c+1) * chunk, (long long)n); a++)
+        {
+            u = order[a];
+            t = membership[u];
+            for (s = directed ? 0 : t; s < n_blocks; s++)
+            {
+                pr = probability[t][s];
+                if (pr <= 0.0) continue;
+
+                b = (s == t and not directed) ? a + 1 : block_start[s];
+                end = block_start[s+1];
+                if (b >= end) continue;
+
+                //Probabilities only decrease along the block: skip with the current one, then accept with the ratio
+                p = min(1.0, theta[u] * theta[order[b]] * pr);
+                while (b < end and p > 0.0)
+                {
+                    //Skips that do not fit in the block, even infinite ones when p is tiny, jump to its end
+                    if (p < 1.0)
+                    {
+                        double skip = floor(log1p(-gen.uniform()) / log1p(-p));
+                        if (skip >= end - b) break;
+                        b += (long long)skip;
+                    }
+
+                    v = order[b];
+                    q = min(1.0, theta[u] * theta[v] * pr);
+                    if (v != u and gen.uniform() * p < q) chunk_links[c].push_back(make_pair(first + u, first + v));
+                    p = q;
+                    b += 1;
+                }
+            }
+        }
+    }
+
+    for (c=0; c < n_chunks; c++)
+    {
+        links.insert(links.end(), chunk_links[c].begin(), chunk_links[c].end());
+        vector< pair<unsigned int, unsigned int> >().swap(chunk_links[c]);
+    }
+    add_links(links);
+
+    set_membership(property, first, membership);
+
+    return;
+}
+
+
+/** \brief Generates a LFR benchmark network with communities
+*  \param nodes: nodes of the network
+*  \param min_degree, max_degree: limits of the degree distribution
+*  \param degree_exponent: exponent of the power law of the degrees
+*  \param size_exponent: exponent of the power law of the community sizes
+*  \param mixing: fraction of the links of each node going to other communities
+*  \param min_size, max_size: limits of the size of the communities
+*  \param property: optional, default "community". Name of the int node property where the community is stored.
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Benchmark of Lancichinetti, Fortunato and Radicchi. Each node gets a degree k and round((1-mixing) k) links inside its
+* community, and it goes to a community larger than that. Links inside each community are made with a configuration
+* model, in parallel, and links between communities with another one over all the network; in both cases self-loops,
+* multi-links and links between nodes of the same community are removed with switchings (see repair_links), so
+* degrees are kept. If a node does not fit in any community with room left its internal degree is reduced. In directed
+* networks links have random direction.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_lfr(int n, int min_degree, int max_degree, double degree_exponent, double size_exponent, double mixing,
+                                       int min_size, int max_size, string property, unsigned int random_seed)
+{
+    int i, j, c, first, n_communities, total;
+    long long l, n_external;
+
+    vector<int> degree, internal, size, membership, community_start, filled, open, by_internal;
+    vector<unsigned int> members, stubs, from, to;
+    vector< vector< pair<unsigned int, unsigned int> > > community_links;
+    vector< pair<unsigned int, unsigned int> > links;
+
+    rng_stream gen(random_seed);
+
+    //Integer from a power law between low and high
+    auto power_law = [&gen](int low, int high, double exponent) -> int
+    {
+        double u = gen.uniform();
+        double x;
+        if (fabs(exponent - 1.0) < 1e-9) x = low * pow((high + 1.0) / low, u);
+        else
+        {
+            double a = pow(low, 1.0 - exponent);
+            double b = pow(high + 1.0, 1.0 - exponent);
+            x = pow(a + u * (b - a), 1.0 / (1.0 - exponent));
+        }
+        return min(high, max(low, (int)floor(x)));
+    };
+
+    first = current_size;
+    add_nodes(n);
+    n = current_size - first;
+    if (n == 0) return;
+
+    max_size = min(max_size, n);
+    min_size = min(min_size, max_size);
+
+    //Degrees and community sizes, adding communities until all nodes are in one
+    degree = vector<int>(n);
+    internal = vector<int>(n);
+    for (i=0; i < n; i++)
+    {
+        degree[i] = power_law(min_degree, max_degree, degree_exponent);
+        internal[i] = round((1.0 - mixing) * degree[i]);
+    }
+
+    total = 0;
+    while (total < n)
+    {
+        size.push_back(power_law(min_size, max_size, size_exponent));
+        total += size.back();
+    }
+    size.back() -= total - n;
+    if (size.back() < min_size and size.size() > 1)
+    {
+        //Give the rest to the other communities
+        int extra = size.back();
+        size.pop_back();
+        for (c=0; extra > 0; c = (c + 1) % size.size(), extra--) size[c] += 1;
+    }
+    sort(size.begin(), size.end(), greater<int>());
+    n_communities = size.size();
+
+    //Nodes with more internal links choose first, among the communities large enough that still have room
+    by_internal = vector<int>(n);
+    for (i=0; i < n; i++) by_internal[i] = i;
+    parallel_shuffle(by_internal, gen());
+    stable_sort(by_internal.begin(), by_internal.end(), [&internal](int x, int y) {return internal[x] > internal[y];});
+
+    membership = vector<int>(n);
+    filled = vector<int>(n_communities, 0);
+    c = 0;
+    for (j=0; j < n; j++)
+    {
+        i = by_internal[j];
+        while (c < n_communities and size[c] > internal[i]) open.push_back(c++);
+
+        if (open.size() == 0)
+        {
+            //No community is large enough: use the largest with room
+            int best = 0;
+            for (int d=1; d < n_communities; d++) if (size[d] - filled[d] > size[best] - filled[best]) best = d;
+            membership[i] = best;
+        }
+        else
+        {
+            int k = gen.below(open.size());
+            membership[i] = open[k];
+        }
+
+        int m = membership[i];
+        filled[m] += 1;
+        internal[i] = min(internal[i], size[m] - 1);
+        if (filled[m] == size[m])
+        {
+            for (int k=0; k < (int)open.size(); k++)
+            {
+                if (open[k] == m)
+                {
+                    open[k] = open.back();
+                    open.pop_back();
+                    break;
+                }
+            }
+        }
+    }
+
+    //Members of each community
+    community_start = vector<int>(n_communities+1, 0);
+    for (i=0; i < n; i++) community_start[membership[i]+1] += 1;
+    for (c=0; c < n_communities; c++) community_start[c+1] += community_start[c];
+    members = vector<unsigned int>(n);
+    filled = vector<int>(community_start.begin(), community_start.end() - 1);
+    for (i=0; i < n; i++) members[filled[membership[i]]++] = i;
+
+    //Internal degrees must have even sum in each community
+    for (c=0; c < n_communities; c++)
+    {
+        long long sum = 0;
+        for (j=community_start[c]; j < community_start[c+1]; j++) sum += internal[members[j]];
+        for (j=community_start[c]; j < community_start[c+1] and sum % 2 == 1; j++)
+        {
+            i = members[j];
+            if (internal[i] < degree[i] and internal[i] < community_start[c+1] - community_start[c] - 1)
+            {
+                internal[i] += 1;
+                sum += 1;
+            }
+            else if (internal[i] > 0)
+            {
+                internal[i] -= 1;
+                sum -= 1;
+            }
+        }
+    }
+
+    //Links inside each community
+    community_links = vector< vector< pair<unsigned int, unsigned int> > >(n_communities);
+
+    #pragma omp parallel for schedule(dynamic, 1) private(i, j, l)
+    for (c=0; c < n_communities; c++)
+    {
+        rng_stream local(random_seed, 1ULL + c);
+        vector<unsigned int> community_stubs, out_end, in_end;
+
+        for (j=community_start[c]; j < community_start[c+1]; j++)
+        {
+            for (i=0; i < internal[members[j]]; i++) community_stubs.push_back(members[j]);
+        }
+        for (l = (long long)community_stubs.size() - 1; l > 0; l--) swap(community_stubs[l], community_stubs[local.below(l+1)]);
+
+        for (l=0; l + 1 < (long long)community_stubs.size(); l += 2)
+        {
+            out_end.push_back(community_stubs[l]);
+            in_end.push_back(community_stubs[l+1]);
+        }
+        repair_links(out_end, in_end, local);
+
+        for (l=0; l < (long long)out_end.size(); l++) community_links[c].push_back(make_pair(first + out_end[l], first + in_end[l]));
+    }
+
+    //Links between communities
+    n_external = 0;
+    for (i=0; i < n; i++) n_external += degree[i] - internal[i];
+    if (n_external % 2 == 1) degree[gen.below(n)] += 1;
+
+    stubs.reserve(n_external + 1);
+    for (i=0; i < n; i++)
+    {
+        for (j=internal[i]; j < degree[i]; j++) stubs.push_back(i);
+    }
+    parallel_shuffle(stubs, gen());
+
+    from = vector<unsigned int>(stubs.size() / 2);
+    to = vector<unsigned int>(stubs.size() / 2);
+    for (l=0; l < (long long)from.size(); l++)
+    {
+        from[l] = stubs[2*l];
+        to[l] = stubs[2*l+1];
+    }
+    vector<unsigned int>().swap(stubs);
+    if (from.size() > 1 and n_communities > 1) repair_links(from, to, gen, membership);
+    else from.clear(); //With one community there can not be links between communities
+
+    for (c=0; c < n_communities; c++) links.insert(links.end(), community_links[c].begin(), community_links[c].end());
+    for (l=0; l < (long long)from.size(); l++) links.push_back(make_pair(first + from[l], first + to[l]));
+
+    //Random directions
+    if (directed)
+    {
+        for (l=0; l < (long long)links.size(); l++) if (gen.below(2) == 1) swap(links[l].first, links[l].second);
+    }
+
+    add_links(links);
+
+    set_membership(property, first, membership);
+
+    return;
+}
+
+
+/** \brief Stores the group of the new nodes as an int node property
+*  \param property: name of the property. It is created if it does not exist.
+*  \param first: index of the first new node
+*  \param membership: group of each new node
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::set_membership(string property, int first, const vector<int> &membership)
+{
+    int i;
+
+    if (prop_i.find(property) == prop_i.end() or (int)prop_i[property].size() != first) define_property(property, "int", true);
+    prop_i[property].resize(current_size, 0);
+    for (i=0; i < (int)membership.size(); i++) prop_i[property][first + i] = membership[i];
+
+    return;
+}
+
+
+
+/** \brief Generates a random geometric network
+*  \param nodes: nodes of the network
+*  \param radius: nodes closer than this are linked
+*  \param dimension: optional, default 2. Nodes are placed uniformly in the unit square (2) or cube (3).
+*  \param periodic: optional, default false. If true, distances are measured in a torus.
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* The coordinates of each node are stored in the double node properties "x", "y" and "z", so they are exported to
+* GraphML. Close pairs are found with cell lists in O(N + E), in parallel over cells (see spatial_links). In directed
+* networks each link is added in both directions.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_random_geometric(int n, double radius, int dimension, bool periodic, unsigned int random_seed)
+{
+    spatial_links(n, radius, function<double(double)>(), dimension, periodic, random_seed);
+    return;
+}
+
+
+/** \brief Generates a soft random geometric network
+*  \param nodes: nodes of the network
+*  \param cutoff: nodes farther than this are never linked
+*  \param kernel: probability of linking two nodes at a given distance, for example exp(-(d/r)^2). It is called in
+*  parallel, so it must not change any shared state.
+*  \param dimension: optional, default 2. Nodes are placed uniformly in the unit square (2) or cube (3).
+*  \param periodic: optional, default false. If true, distances are measured in a torus.
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* As create_random_geometric, but each pair closer than cutoff is linked with probability kernel(distance). The
+* coordinates are stored in the double node properties "x", "y" and "z".
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_soft_geometric(int n, double cutoff, function<double(double)> kernel, int dimension, bool periodic,
+                                                  unsigned int random_seed)
+{
+    spatial_links(n, cutoff, kernel, dimension, periodic, random_seed);
+    return;
+}
+
+
+/** \brief Places nodes at random and links the close ones
+*  \param n: nodes to add
+*  \param cutoff: maximum distance of a link
+*  \param kernel: probability of a link at each distance. If empty, all pairs closer than cutoff are linked.
+*  \param dimension: 2 or 3
+*  \param periodic: distances in a torus
+*  \param random_seed: seed for positions and links
+*
+* Space is split in cells with side at least cutoff, at most about one per node, and nodes are sorted by cell. A pair
+* can only be linked if the cells are neighbours, so each cell only checks the 3^dimension cells around it, taking each
+* pair of cells once. Positions are drawn in fixed chunks and cells are processed in fixed groups, each with its own
+* random stream, so the network does not depend on the number of threads.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::spatial_links(int n, double cutoff, const function<double(double)> &kernel, int dimension, bool periodic, unsigned int random_seed)
+{
+    const int chunk = 4096;
+    const int group = 256;
+    const string axis[3] = {"x", "y", "z"};
+    int i, k, first, side, n_chunks, n_groups;
+    long long c, n_cells;
+
+    vector<double> coords;
+    vector<long long> cell_of, cell_start;
+    vector<unsigned int> in_cell;
+    vector< vector< pair<unsigned int, unsigned int> > > group_links;
+    vector< pair<unsigned int, unsigned int> > links;
+
+    if (dimension < 2 or dimension > 3)
+    {
+        cout << "WARNING [DirectedCNetwork]: dimension must be 2 or 3. Nothing done." << endl;
+        return;
+    }
+
+    first = current_size;
+    add_nodes(n);
+    n = current_size - first;
+    if (n == 0) return;
+
+    //Uniform positions
+    coords = vector<double>((long long)n * dimension);
+    n_chunks = (n + chunk - 1) / chunk;
+    #pragma omp parallel for schedule(static)
+    for (c=0; c < n_chunks; c++)
+    {
+        rng_stream gen(random_seed, c);
+        for (long long j = c * chunk * dimension; j < min((c+1) * chunk, (long long)n) * dimension; j++) coords[j] = gen.uniform();
+    }
+
+    //Cells with side at least cutoff, and not many more than nodes
+    side = cutoff > 0.0 ? (int)floor(1.0 / cutoff) : 1;
+    side = max(1, min(side, (int)floor(pow((double)n, 1.0 / dimension))));
+    n_cells = 1;
+    for (k=0; k < dimension; k++) n_cells *= side;
+
+    cell_of = vector<long long>(n);
+    cell_start = vector<long long>(n_cells + 1, 0);
+    for (i=0; i < n; i++)
+    {
+        c = 0;
+        for (k=0; k < dimension; k++) c = c * side + min(side - 1, (int)(coords[(long long)i * dimension + k] * side));
+        cell_of[i] = c;
+        cell_start[c+1] += 1;
+    }
+    for (c=0; c < n_cells; c++) cell_start[c+1] += cell_start[c];
+    in_cell = vector<unsigned int>(n);
+    {
+        vector<long long> next(cell_start.begin(), cell_start.end() - 1);
+        for (i=0; i < n; i++) in_cell[next[cell_of[i]]++] = i;
+    }
+
+    //Distance between two nodes
+    auto distance = [&](unsigned int a, unsigned int b) -> double
+    {
+        double d2 = 0.0, dx;
+        for (int l=0; l < dimension; l++)
+        {
+            dx = fabs(coords[(long long)a * dimension + l] - coords[(long long)b * dimension + l]);
+            if (periodic) dx = min(dx, 1.0 - dx);
+            d2 += dx * dx;
+        }
+        return sqrt(d2);
+    };
+
+    n_groups = (n_cells + group - 1) / group;
+    group_links = vector< vector< pair<unsigned int, unsigned int> > >(n_groups);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int g=0; g < n_groups; g++)
+    {
+        rng_stream gen(random_seed, (unsigned long long)n_chunks + g);
+        vector<long long> around;
+        int cell[3], other[3], l, off;
+        long long x, y, o, a, b;
+        bool inside;
+        double d;
+
+        for (x = (long long)g * group; x < min((long long)(g+1) * group, n_cells); x++)
+        {
+            //Coordinates of the cell, and the neighbour cells after it
+            o = x;
+            for (l = dimension - 1; l >= 0; l--)
+            {
+                cell[l] = o % side;
+                o /= side;
+            }
+            around.clear();
+            for (off=0; off < (dimension == 2 ? 9 : 27); off++)
+            {
+                o = off;
+                inside = true;
+                y = 0;
+                for (l=0; l < dimension; l++)
+                {
+                    other[l] = cell[l] + (int)(o % 3) - 1;
+                    o /= 3;
+                    if (periodic) other[l] = (other[l] + side) % side;
+                    else if (other[l] < 0 or other[l] >= side) inside = false;
+                    y = y * side + other[l];
+                }
+                if (inside and y >= x) around.push_back(y);
+            }
+            sort(around.begin(), around.end());
+            around.erase(unique(around.begin(), around.end()), around.end());
+
+            for (l=0; l < (int)around.size(); l++)
+            {
+                y = around[l];
+                for (a = cell_start[x]; a < cell_start[x+1]; a++)
+                {
+                    for (b = (y == x ? a + 1 : cell_start[y]); b < cell_start[y+1]; b++)
+                    {
+                        d = distance(in_cell[a], in_cell[b]);
+                        if (d >= cutoff) continue;
+                        if (kernel and gen.uniform() >= kernel(d)) continue;
+                        group_links[g].push_back(make_pair(first + min(in_cell[a], in_cell[b]), first + max(in_cell[a], in_cell[b])));
+                    }
+                }
+            }
+        }
+    }
+
+    for (i=0; i < n_groups; i++)
+    {
+        links.insert(links.end(), group_links[i].begin(), group_links[i].end());
+        vector< pair<unsigned int, unsigned int> >().swap(group_links[i]);
+    }
+    if (directed)
+    {
+        long long n_links = links.size();
+        for (c=0; c < n_links; c++) links.push_back(make_pair(links[c].second, links[c].first));
+    }
+    add_links(links);
+
+    //Store the coordinates
+    for (k=0; k < dimension; k++)
+    {
+        if (prop_d.find(axis[k]) == prop_d.end() or (int)prop_d[axis[k]].size() != first) define_property(axis[k], "double", true);
+        prop_d[axis[k]].resize(current_size, 0.0);
+        for (i=0; i < n; i++) prop_d[axis[k]][first + i] = coords[(long long)i * dimension + k];
+    }
+
+    return;
+}
+
+
+
+/** \brief Generates a Watts-Strogatz network
+*  \param nodes: nodes of the network
+*  \param regular_connections: links going forward from each node in the ring, so the degree is twice this when p=0
+*  \param p: probability of shuffling edges
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Generates a Watts-Strogatz network. Each node i is linked to the next regular_connections nodes in a ring, and each of
+* these links is moved with probability p to a random node, avoiding self-loops and repeated links. The random seed
+* should be specified for obtaining different networks each iteration.
+* Each node has its own random stream and rewires its links in parallel. Repeated links are rejected in O(1): links
+* of the lattice are checked with the list of kept links, and the new ones of the node with a small hash table. In
+* undirected networks two nodes may still choose each other; these few links are drawn again at the end. The cost is
+* O(N k), and the network does not depend on the number of threads. In very small rings a link may have no node left
+* to go to; then it stays in the lattice, or is removed if that would repeat a link, with a warning.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_watts_strogatz(int n, int num_forward_edges, double p, unsigned int random_seed)
+{
+    const int max_tries = 64;
+    int i, d, first, k, size;
+    long long l, n_links, n_kept_back, n_dropped;
+    unsigned long long key;
+
+    vector<char> kept;
+    vector<unsigned int> target;
+    vector< pair<unsigned int, unsigned int> > links;
+
+    k = num_forward_edges;
+    first = current_size;
+    add_nodes(n); //Add the nodes
+    n = current_size - first;
+
+    if (k < 1 or 2 * k >= n)
+    {
+        if (n > 0) cout << "WARNING [DirectedCNetwork]: regular_connections must be between 1 and (N-1)/2. No links added." << endl;
+        return;
+    }
+
+    n_links = (long long)n * k;
+    kept = vector<char>(n_links);
+    target = vector<unsigned int>(n_links);
+
+    //Decide which links of the lattice are kept. Link d-1 of node i goes to i+d
+    #pragma omp parallel for schedule(static) private(d)
+    for (i=0; i < n; i++)
+    {
+        rng_stream gen(random_seed, i);
+        for (d=1; d <= k; d++) kept[(long long)i * k + d-1] = gen.uniform() >= p;
+    }
+
+    //Link of the lattice between a and b still there
+    auto lattice_linked = [&](unsigned int a, unsigned int b) -> bool
+    {
+        long long forward = (b + n - a) % n;
+        long long backward = (a + n - b) % n;
+        if (forward >= 1 and forward <= k and kept[(long long)a * k + forward-1]) return true;
+        return not directed and backward >= 1 and backward <= k and kept[(long long)b * k + backward-1];
+    };
+
+    //Node i can move its link d-1 to this one: not myself, the old neighbour or a node I am still linked to
+    auto allowed = [&](int a, int d_a, unsigned int to) -> bool
+    {
+        return (int)to != a and (int)to != (a + d_a) % n and not lattice_linked(a, to);
+    };
+
+    size = 16;
+    while (size < 4 * k) size *= 2;
+
+    n_kept_back = 0;
+    #pragma omp parallel private(d) reduction(+:n_kept_back)
+    {
+        //Small hash table with the new neighbours of the node, cleared with a stamp
+        vector<unsigned int> table(size);
+        vector<int> stamp(size, -1);
+        unsigned int to;
+        unsigned long long h;
+        int tries;
+
+        auto is_new = [&](int a, unsigned int x) -> bool
+        {
+            unsigned long long y = rng_stream::mix(x) & (size - 1);
+            while (stamp[y] == a and table[y] != x) y = (y + 1) & (size - 1);
+            return stamp[y] != a;
+        };
+
+        #pragma omp for schedule(static)
+        for (i=0; i < n; i++)
+        {
+            rng_stream gen(random_seed, (unsigned long long)n + i);
+            for (d=1; d <= k; d++)
+            {
+                if (kept[(long long)i * k + d-1])
+                {
+                    target[(long long)i * k + d-1] = (i + d) % n;
+                    continue;
+                }
+
+                //Draw again if the node is not allowed or already chosen. In small rings all nodes may be excluded,
+                //so after some tries all of them are checked, and if none is possible the lattice link is kept.
+                to = gen.below(n);
+                for (tries=0; tries < max_tries and not (allowed(i, d, to) and is_new(i, to)); tries++) to = gen.below(n);
+                if (tries == max_tries)
+                {
+                    unsigned int start = to;
+                    do to = (to + 1) % n;
+                    while (to != start and not (allowed(i, d, to) and is_new(i, to)));
+                    if (not (allowed(i, d, to) and is_new(i, to)))
+                    {
+                        to = (i + d) % n;
+                        n_kept_back += 1;
+                    }
+                }
+
+                h = rng_stream::mix(to) & (size - 1);
+                while (stamp[h] == i) h = (h + 1) & (size - 1);
+                stamp[h] = i;
+                table[h] = to;
+                target[(long long)i * k + d-1] = to;
+            }
+        }
+    }
+
+    //In undirected networks, i->j and j->i could both be drawn. Draw again the second one.
+    n_dropped = 0;
+    if (not directed and p > 0.0)
+    {
+        long long n_rewired = 0;
+        for (l=0; l < n_links; l++) n_rewired += not kept[l];
+
+        link_set existing(n_rewired);
+        rng_stream gen(random_seed, 2ULL * n);
+        for (l=0; l < n_links; l++)
+        {
+            if (kept[l]) continue;
+
+            i = l / k;
+            d = l % k + 1;
+            unsigned int a = min((unsigned int)i, target[l]);
+            unsigned int b = max((unsigned int)i, target[l]);
+            key = ((unsigned long long)a << 32) | b;
+
+            if (not existing.contains(key))
+            {
+                existing.insert(key);
+                continue;
+            }
+
+            //Same rule as before, and the link must not be there yet. Checked over all nodes if it is hard to find.
+            auto free_link = [&](unsigned int to) -> bool
+            {
+                return allowed(i, d, to) and not existing.contains(((unsigned long long)min((unsigned int)i, to) << 32) | max((unsigned int)i, to));
+            };
+            unsigned int to = gen.below(n);
+            int tries;
+            for (tries=0; tries < max_tries and not free_link(to); tries++) to = gen.below(n);
+            if (tries == max_tries)
+            {
+                unsigned int start = to;
+                do to = (to + 1) % n;
+                while (to != start and not free_link(to));
+            }
+            if (not free_link(to))
+            {
+                //Stay in the lattice, if that link is not there yet
+                to = (i + d) % n;
+                if (target[l] != to) n_kept_back += 1;
+            }
+
+            key = ((unsigned long long)min((unsigned int)i, to) << 32) | max((unsigned int)i, to);
+            if (existing.contains(key))
+            {
+                if (target[l] == to) n_kept_back -= 1;
+                target[l] = n; //Nothing possible: the link is dropped
+                n_dropped += 1;
+            }
+            else
+            {
+                target[l] = to;
+                existing.insert(key);
+            }
+        }
+    }
+
+    if (n_kept_back > 0) cout << "WARNING [DirectedCNetwork]: " << n_kept_back << " links had no free node to be moved to and stayed in the lattice." << endl;
+    if (n_dropped > 0) cout << "WARNING [DirectedCNetwork]: " << n_dropped << " links had no free node to be moved to and were removed." << endl;
+
+    links.reserve(n_links - n_dropped);
+    for (l=0; l < n_links; l++)
+    {
+        if ((int)target[l] < n) links.push_back(make_pair(first + l / k, first + target[l]));
+    }
+
+    add_links(links);
+
+    return;
+}
+
+
+/** \brief Generates an Albert-Barabasi network
+*  \param n: nodes of the network
+*  \param m0: initial number of fully-connected nodes. At least m.
+*  \param m: new links added for each node
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Generates an Albert-Barabasi network: each new node links to exactly m different older nodes, chosen with
+* probability proportional to their degree. Same as create_preferential_attachment with no attractiveness. The
+* random seed should be specified for obtaining different networks each iteration.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_albert_barabasi(int n, int m0, int m, unsigned int random_seed)
+{
+    create_preferential_attachment(n, m0, m, 0.0, random_seed);
+    return;
+}
+
+
+/** \brief Generates a network with linear preferential attachment
+*  \param n: nodes of the network
+*  \param m0: initial number of fully-connected nodes. At least m.
+*  \param m: new links added for each node
+*  \param attractiveness: optional, default 0. Initial attractiveness A, larger than -m. Old nodes are chosen with
+*  probability proportional to k + A, so the degree distribution decays as k^-(3 + A/m).
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*
+* Each new node links to exactly m different older nodes. Targets are sampled in O(1) from the list of link ends,
+* and nodes are processed in parallel following Sanders and Schulz (see attachment_process), so the cost is O(N m)
+* and the network does not depend on the number of threads. In directed networks links go from new to old nodes.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::create_preferential_attachment(int n, int m0, int m, double attractiveness, unsigned int random_seed)
+{
+    int i, j, first;
+    long long v, k, clique_links;
+
+    vector< pair<unsigned int, unsigned int> > links;
+
+    if (m0 < m)
+    {
+        cout << "WARNING [DirectedCNetwork]: initial nodes m0 must be at least m. Using m0 = m." << endl;
+        m0 = m;
+    }
+    if (m > 0 and attractiveness <= -m)
+    {
+        cout << "WARNING [DirectedCNetwork]: attractiveness must be larger than -m. Using 0." << endl;
+        attractiveness = 0.0;
+    }
+
+    first = current_size;
+    add_nodes(n);
+    n = current_size - first;
+    m0 = min(m0, n);
+
+    //Fully connected network with m0 nodes
+    clique_links = (long long)m0 * (m0 - 1) / 2;
+    links.reserve(clique_links + (long long)(n - m0) * m);
+    for (i=0; i < m0; i++)
+    {
+        for (j=i+1; j < m0; j++) links.push_back(make_pair(first + i, first + j));
+    }
+
+    if (m > 0 and n > m0)
+    {
+        attachment_process process(n, m0, m, attractiveness, random_seed);
+
+        #pragma omp parallel for schedule(dynamic, 4096)
+        for (v=m0; v < n; v++)
+        {
+            char ready;
+            #pragma omp atomic read
+            ready = process.done[v - m0];
+            if (not ready) process.attach(v);
+        }
+
+        //New nodes point to older ones
+        for (v=m0; v < n; v++)
+        {
+            for (k=0; k < m; k++) links.push_back(make_pair(first + v, first + process.target[(v - m0) * m + k]));
+        }
+    }
+
+    add_links(links);
+
+    return;
+}
+
+
+
+/** \brief Randomizes the network keeping the degree of every node
+*  \param swaps: number of double edge swaps to try. 10 times the number of links is usually enough.
+*  \param random_seed: optional, default 123456789. Same seed gives the same network.
+*  \return number of swaps accepted
+*
+* Double edge swap Markov chain. Two links a-b and c-d are replaced by a-d and c-b, unless this would create a self-loop
+* or a link that already exists, which is checked in O(1) with a hash set. In directed networks in and out degrees are
+* kept. Links are changed in place in adjm, so their weights and indices are kept, and neighbours are rebuilt at the end.
+*/
+template <class T, typename B>
+long long DirectedCNetwork<T,B>::rewire(long long swaps, unsigned int random_seed)
+{
+    int i;
+    long long accepted;
+
+    vector<unsigned int> from(link_count), to(link_count);
+    rng_stream gen(random_seed);
+
+    for (i=0; i < link_count; i++)
+    {
+        from[i] = adjm.m[i].x;
+        to[i] = adjm.m[i].y;
+    }
+
+    accepted = edge_swaps(from, to, swaps, gen);
+
+    for (i=0; i < link_count; i++)
+    {
+        adjm.m[i].x = from[i];
+        adjm.m[i].y = to[i];
+    }
+    rebuild_neighbours();
+
+    return accepted;
+}
+
+
+/** \brief Creates several independent randomized versions of the network
+*  \param n_samples: number of null samples
+*  \param swaps: number of double edge swaps tried for each sample
+*  \param[out] samples: element j is the list of links of the j-th sample. Link i of every sample takes the place of
+*  link i of the network, so weights and properties of links can be read from the original one.
+*  \param random_seed: optional. Sample j uses the stream j of this seed, for any number of threads.
+*
+* Same as rewire, but the network is not changed and samples are computed in parallel.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::rewired_samples(int n_samples, long long swaps, vector< vector< pair<unsigned int, unsigned int> > > &samples, unsigned int random_seed) const
+{
+    int i;
+
+    samples = vector< vector< pair<unsigned int, unsigned int> > >(n_samples);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (i=0; i < n_samples; i++)
+    {
+        vector<unsigned int> from(link_count), to(link_count);
+        rng_stream gen(random_seed, i);
+
+        for (int j=0; j < link_count; j++)
+        {
+            from[j] = adjm.m[j].x;
+            to[j] = adjm.m[j].y;
+        }
+
+        edge_swaps(from, to, swaps, gen);
+
+        samples[i] = vector< pair<unsigned int, unsigned int> >(link_count);
+        for (int j=0; j < link_count; j++) samples[i][j] = make_pair(from[j], to[j]);
+    }
+
+    return;
+}
+
+
+/** \brief Double edge swaps over a list of links
+*  \param from, to: ends of each link, changed in place
+*  \param swaps: number of swaps to try
+*  \param gen: random stream
+*  \return number of swaps accepted
+*
+* Links are kept in a link_set, so multi-links already in the network are not a problem. In undirected
+* networks one of the two possible swaps is chosen at random.
+*/
+template <class T, typename B>
+long long DirectedCNetwork<T,B>::edge_swaps(vector<unsigned int> &from, vector<unsigned int> &to, long long swaps, rng_stream &gen) const
+{
+    long long s, accepted;
+    int i, j;
+    int n = from.size();
+    unsigned int a, b, c, d;
+    unsigned long long key_ad, key_cb;
+
+    link_set existing(n);
+
+    if (n < 2) return 0;
+
+    //Key of a link. Undirected ones are stored with the smallest index first
+    auto key = [this](unsigned int x, unsigned int y) -> unsigned long long
+    {
+        if (not directed and y < x) swap(x, y);
+        return ((unsigned long long)x << 32) | y;
+    };
+
+    for (i=0; i < n; i++) existing.insert(key(from[i], to[i]));
+
+    accepted = 0;
+    for (s=0; s < swaps; s++)
+    {
+        i = gen.below(n);
+        j = gen.below(n);
+        if (i == j) continue;
+
+        a = from[i];
+        b = to[i];
+        c = from[j];
+        d = to[j];
+        if (not directed and gen.below(2) == 1) swap(c, d);
+
+        //No self-loops or multi-links
+        if (a == d or c == b) continue;
+        key_ad = key(a, d);
+        key_cb = key(c, b);
+        if (key_ad == key_cb or existing.contains(key_ad) or existing.contains(key_cb)) continue;
+
+        existing.erase(key(from[i], to[i]));
+        existing.erase(key(from[j], to[j]));
+        existing.insert(key_ad);
+        existing.insert(key_cb);
+
+        to[i] = d;
+        from[j] = c;
+        to[j] = b;
+        accepted += 1;
+    }
+
+    return accepted;
+}
+
+
+/** \brief Rebuilds the lists of neighbours from adjm
+*
+* Used after changing the links of adjm directly. Keeps the node order of adjm.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::rebuild_neighbours()
+{
+    int i;
+    unsigned int x, y;
+
+    for (i=0; i < current_size; i++)
+    {
+        neighs[i].clear();
+        if (directed) pointing_in[i].clear();
+    }
+
+    for (i=0; i < link_count; i++)
+    {
+        x = adjm.m[i].x;
+        y = adjm.m[i].y;
+        neighs[x].push_back(y);
+        if (directed) pointing_in[y].push_back(x);
+        else neighs[y].push_back(x);
+    }
+
+    comp_dirty = true;
+    return;
+}
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+/** \brief Gets the in-degree of the target node
+*  \param node_index: target node
+*  \return in-degree of target node
+*
+* Returns the in-degree of the target node
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::in_degree(int node_index) const
+{
+    return pointing_in[node_index].size();
+}
+
+/** \brief Gets the out-degree of the target node
+*  \param node_index: target node
+*  \return out-degree of target node
+*
+* Returns the out-degree of the target node
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::out_degree(int node_index) const
+{
+    return neighs[node_index].size();
+}
+
+
+/** \brief Gets the degree of the target node
+*  \param node_index: target node
+*  \return degree of target node
+*
+* Returns the degree of the target node
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::degree(int node_index) const
+{
+    return pointing_in[node_index].size() + neighs[node_index].size();
+}
+
+/** \brief Gets a link between two specified nodes
+*  \param from: origin node
+*  \param to: destination node
+*  \return index of the link between from and destination.
+*
+* Returns the index of the link that connects nodes from and to. If there is no link, then
+* it returns -1.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::get_link_index(int from, int to) const
+{
+    int i;
+    bool found = false;
+
+    i = 0;
+    while (i < link_count and not found)
+    {
+        found = ((int)adjm[i].x == from and (int)adjm[i].y == to);
+        i += 1;
+    }
+
+    return found ? i-1 : -1; //Remember we have just summed i
+}
+
+
+/** \brief Gets a link by its index
+*  \param link_index: index of target link
+*  \return vector containing origin and target node indices
+*
+* Returns a vector (node_origin, node_destination) given the link index
+*/
+template <class T, typename B>
+vector<int> DirectedCNetwork<T,B>::get_link(int link_index) const
+{
+    return {(int)adjm[link_index].x, (int)adjm[link_index].y};
+}
+
+
+/** \brief Gets a link weight
+*  \param link_index: index of target link
+*  \return link weight
+*
+* Returns the object ("weight") associated with the specified link
+*/
+template <class T, typename B>
+B DirectedCNetwork<T,B>::get_weight(int link_index) const
+{
+    return adjm[link_index].value;
+}
+
+
+/** \brief Gets a link weight
+*  \param link_index: index of target link
+*  \param weight: desired weight of the link
+*
+* Sets the object ("weight") associated with the specified link
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::set_weight(int link_index, B weight)
+{
+    adjm[link_index].value = weight;
+    return;
+}
+
+
+/** \brief Total number of nodes in the network
+*  \return number of nodes in the network
+*
+* Returns the total number of nodes initialized in the network
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::get_node_count() const
+{
+    return current_size;
+}
+
+
+/** \brief Total number of links in the network
+*  \return number of links in the network
+*
+* Returns the total number of links initialized in the network
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::get_link_count() const
+{
+    return link_count;
+}
+
+
+
+/** \brief Get the nodes the node is pointing to
+*  \param node_index: target node
+*  \return vector containing the indices of the neighbour nodes of the target node
+*
+* Returns the a vector with the indices of the neighbours pointed by the specified node.
+*/
+template <class T, typename B>
+vector<unsigned int> DirectedCNetwork<T,B>::get_neighs_out(int node_index) const
+{
+    return neighs[node_index];
+}
+
+
+/** \brief Get the nodes pointing to me in the network
+*  \param node_index: target node
+*  \return vector containing the indices of the nodes that point to the target node
+*
+* Returns the a vector with the indices of the nodes that point to the specified node.
+*/
+template <class T, typename B>
+vector<unsigned int> DirectedCNetwork<T,B>::get_neighs_in(int node_index) const
+{
+    return pointing_in[node_index];
+}
+
+
+/** \brief Selects a neighbour of a given node
+*  \param node_index: target node
+*  \param k: neighbour to be selected
+*  \return index of the k-th neighbour of the target node
+*
+* Returns the index of the k-th neighbour of the target node. Neighbours are unsorted
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::get_out(int node_index, int k) const
+{
+    return neighs[node_index][k];
+}
+
+
+/** \brief Selects a node pointing to the given node
+*  \param node_index: target node
+*  \param k: node to be selected
+*  \return index of the k-th neighbour of the list of nodes pointing to me
+*
+* Returns the index of the k-th node pointing to the target node.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::get_in(int node_index, int k) const
+{
+    return pointing_in[node_index][k];
+}
+
+
+/** \brief Define a new tag for the network
+*  \param name: tag identifier
+*  \param type: can be int, double, string, or bool.
+*  \param is_for_nodes: if false, this property is assigned to links
+*
+* Define a new property or tag. This will be exported to GraphML. It can
+* be used also as additional properties for network dynamics.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::define_property(string name, string type, bool is_for_nodes)
+{
+    int n = is_for_nodes ? current_size : link_count;
+
+    if (type == "double")
+    {
+        prop_d[name] = vector<double>(n, 0.0);
+    }
+    else if (type == "int")
+    {
+        prop_i[name] = vector<int>(n, 0);
+    }
+    else if (type == "bool")
+    {
+        prop_b[name] = vector<bool>(n, false);
+    }
+    else if (type == "string")
+    {
+        prop_s[name] = vector<string>(n, "");
+    }
+    return;
+}
+
+
+/** \brief Set the value of an existing property
+*  \param name: tag identifier
+*  \param index: index or node or link where it has to be stored
+*  \param value: the new value
+*
+* Set a value for the property "name" in the node or link index. Note that
+* user must take care of manually checking index bounds.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::set_value(string name, int index, double value)
+{
+    prop_d[name][index] = value;
+}
+
+/** \brief Set the value of an existing property
+*  \param name: tag identifier
+*  \param index: index or node or link where it has to be stored
+*  \param value: the new value
+*
+* Set a value for the property "name" in the node or link index. Note that
+* user must take care of manually checking index bounds.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::set_value(string name, int index, int value)
+{
+    prop_i[name][index] = value;
+}
+
+
+/** \brief Set the value of an existing property
+*  \param name: tag identifier
+*  \param index: index or node or link where it has to be stored
+*  \param value: the new value
+*
+* Set a value for the property "name" in the node or link index. Note that
+* user must take care of manually checking index bounds.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::set_value(string name, int index, bool value)
+{
+    prop_b[name][index] = value;
+}
+
+
+/** \brief Set the value of an existing property
+*  \param name: tag identifier
+*  \param index: index or node or link where it has to be stored
+*  \param value: the new value
+*
+* Set a value for the property "name" in the node or link index. Note that
+* user must take care of manually checking index bounds.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::set_value(string name, int index, string value)
+{
+    prop_s[name][index] = value;
+}
+
+
+/** \brief Get the value of an existing property
+*  \param name: tag identifier
+*  \param index: index or node or link where it has to be stored
+*  \return value stored
+*
+* Get a value for the property "name" in the node or link index. Note that
+* user must take care of manually checking index bounds.
+*/
+template <class T, typename B>
+double DirectedCNetwork<T,B>::get_value_d(string name, int index)
+{
+    return prop_d[name][index];
+}
+
+/** \brief Get the value of an existing property
+*  \param name: tag identifier
+*  \param index: index or node or link where it has to be stored
+*  \return value stored
+*
+* Get a value for the property "name" in the node or link index. Note that
+* user must take care of manually checking index bounds.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::get_value_i(string name, int index)
 {
-    int i,j,k;
+    return prop_i[name][index];
+}
+
+/** \brief Get the value of an existing property
+*  \param name: tag identifier
+*  \param index: index or node or link where it has to be stored
+*  \return value stored
+*
+* Get a value for the property "name" in the node or link index. Note that
+* user must take care of manually checking index bounds.
+*/
+template <class T, typename B>
+bool DirectedCNetwork<T,B>::get_value_b(string name, int index)
+{
+    return prop_b[name][index];
+}
+
+/** \brief Get the value of an existing property
+*  \param name: tag identifier
+*  \param index: index or node or link where it has to be stored
+*  \return value stored
+*
+* Get a value for the property "name" in the node or link index. Note that
+* user must take care of manually checking index bounds.
+*/
+template <class T, typename B>
+string DirectedCNetwork<T,B>::get_value_s(string name, int index)
+{
+    return prop_s[name][index];
+}
+
+/** \brief Export network data to GraphML, Gephi compatible format
+*  \param filename: name of the file (without extension)
+*  \param labels: optional. Tags used to name the nodes
+*
+* Export the network data. Properties defined via define_property will be stored as node or link
+* properties. In addition to that, it is also possible to label directly the nodes. This will be
+* recognized as a node identifier in software like Gephi. For compatibility, MTX format is preferred
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels) const
+{
+    int i;
     ofstream output;
     string is_for_nodes;
 
@@ -1529,22 +7436,22 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
     //Create all the properties
     for (auto &property : prop_d)
     {
-        is_for_nodes = property.second.size() == current_size ? "node" : "edge";
+        is_for_nodes = (int)property.second.size() == current_size ? "node" : "edge";
         output << "<key attr.name=\"" << property.first << "\" attr.type=\"double\" for=\""<< is_for_nodes <<"\" id=\"id_" << property.first << "\" />" << endl;
     }
     for (auto &property : prop_i)
     {
-        is_for_nodes = property.second.size() == current_size ? "node" : "edge";
+        is_for_nodes = (int)property.second.size() == current_size ? "node" : "edge";
         output << "<key attr.name=\"" << property.first << "\" attr.type=\"int\" for=\""<< is_for_nodes <<"\" id=\"id_" << property.first << "\" />" << endl;
     }
     for (auto &property : prop_b)
     {
-        is_for_nodes = property.second.size() == current_size ? "node" : "edge";
+        is_for_nodes = (int)property.second.size() == current_size ? "node" : "edge";
         output << "<key attr.name=\"" << property.first << "\" attr.type=\"boolean\" for=\""<< is_for_nodes <<"\" id=\"id_" << property.first << "\" />" << endl;
     }
     for (auto &property  : prop_s)
     {
-        is_for_nodes = property.second.size() == current_size ? "node" : "edge";
+        is_for_nodes = (int)property.second.size() == current_size ? "node" : "edge";
         output << "<key attr.name=\"" << property.first << "\" attr.type=\"string\" for=\""<< is_for_nodes <<"\" id=\"id_" << property.first << "\" />" << endl;
     }
 
@@ -1564,7 +7471,7 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
             //Property addition
             for (auto &property : prop_d)
             {
-                if (property.second.size() == current_size ) //If this property if for nodes,
+                if ((int)property.second.size() == current_size ) //If this property if for nodes,
                 {
                     //Then add it to our node
                     output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
@@ -1574,21 +7481,21 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
             //Do the same with all other properties
             for (auto &property : prop_i)
             {
-                if (property.second.size() == current_size )
+                if ((int)property.second.size() == current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
             }
             for (auto &property : prop_b)
             {
-                if (property.second.size() == current_size )
+                if ((int)property.second.size() == current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
             }
             for (auto &property : prop_s)
             {
-                if (property.second.size() == current_size )
+                if ((int)property.second.size() == current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
@@ -1602,7 +7509,7 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
             output << "<edge source=\"" << labels[adjm[i].x] << "\" target=\"" << labels[adjm[i].y] << "\">" << endl;
             for (auto &property : prop_d)
             {
-                if (property.second.size() != current_size ) //If this property if for links,
+                if ((int)property.second.size() != current_size ) //If this property if for links,
                 {
                     //Then add it to our node
                     output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
@@ -1612,21 +7519,21 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
             //Do the same with all other properties
             for (auto &property : prop_i)
             {
-                if (property.second.size() != current_size )
+                if ((int)property.second.size() != current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
             }
             for (auto &property : prop_b)
             {
-                if (property.second.size() != current_size )
+                if ((int)property.second.size() != current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
             }
             for (auto &property : prop_s)
             {
-                if (property.second.size() != current_size )
+                if ((int)property.second.size() != current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
@@ -1642,7 +7549,7 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
             //Property addition
             for (auto &property : prop_d)
             {
-                if (property.second.size() == current_size ) //If this property if for nodes,
+                if ((int)property.second.size() == current_size ) //If this property if for nodes,
                 {
                     //Then add it to our node
                     output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
@@ -1652,21 +7559,21 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
             //Do the same with all other properties
             for (auto &property : prop_i)
             {
-                if (property.second.size() == current_size )
+                if ((int)property.second.size() == current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
             }
             for (auto &property : prop_b)
             {
-                if (property.second.size() == current_size )
+                if ((int)property.second.size() == current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
             }
             for (auto &property : prop_s)
             {
-                if (property.second.size() == current_size )
+                if ((int)property.second.size() == current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
@@ -1680,7 +7587,7 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
             output << "<edge source=\"" << adjm[i].x << "\" target=\"" << adjm[i].y << "\">" << endl;
             for (auto &property : prop_d)
             {
-                if (property.second.size() != current_size ) //If this property if for links,
+                if ((int)property.second.size() != current_size ) //If this property if for links,
                 {
                     //Then add it to our node
                     output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
@@ -1690,21 +7597,21 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
             //Do the same with all other properties
             for (auto &property : prop_i)
             {
-                if (property.second.size() != current_size )
+                if ((int)property.second.size() != current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
             }
             for (auto &property : prop_b)
             {
-                if (property.second.size() != current_size )
+                if ((int)property.second.size() != current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
             }
             for (auto &property : prop_s)
             {
-                if (property.second.size() != current_size )
+                if ((int)property.second.size() != current_size )
                 {
                    output << "<data key=\"id_" << property.first << "\">"  << property.second[i] << "</data>" << endl;
                 }
@@ -1721,116 +7628,769 @@ void DirectedCNetwork<T,B>::write_graphml(string filename, vector<string> labels
 
 
 
-/** \brief Export network data to plain MTX format
-*  \param filename: name of the file (without extension)
-*
-* The MTX format is defined by a simple plaintext representation of the adjancency matrix.
-* This is compatible with most network-analysis software, and it is easy to read from any language.
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::write_mtx(string filename) const
-{
-    ofstream output;
-    int i;
-
-    output.open(filename + ".mtx");
-    //Write that this is a NxN matrix with link_count links
-    output << "%Network created using DirectedCNetwork 1.0" << endl;
-    output << current_size << " " << current_size << " " << link_count << endl;
-    //Check if the used decided to use a weighted net
-    if (typeid(B) == typeid(bool))
-    {
-        for (i=0; i < link_count; i++)
-        {
-            output << adjm[i].x << " " << adjm[i].y << endl; //Using a weight 1
-        }
-    }
-    else
-    {
-        for (i=0; i < link_count; i++)
-        {
-            output << adjm[i].x << " " << adjm[i].y << " " << adjm[i].value << endl; //Arbitrary weight
-        }
-    }
-    output.close();
-}
+/** \brief Export network data to plain MTX format
+*  \param filename: name of the file (without extension)
+*
+* The MTX format is defined by a simple plaintext representation of the adjancency matrix.
+* This is compatible with most network-analysis software, and it is easy to read from any language.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::write_mtx(string filename) const
+{
+    ofstream output;
+    int i;
+
+    output.open(filename + ".mtx");
+    //Write that this is a NxN matrix with link_count links
+    output << "%Network created using DirectedCNetwork 1.0" << endl;
+    output << current_size << " " << current_size << " " << link_count << endl;
+    //Check if the used decided to use a weighted net
+    if (typeid(B) == typeid(bool))
+    {
+        for (i=0; i < link_count; i++)
+        {
+            output << adjm[i].x << " " << adjm[i].y << endl; //Using a weight 1
+        }
+    }
+    else
+    {
+        for (i=0; i < link_count; i++)
+        {
+            output << adjm[i].x << " " << adjm[i].y << " " << adjm[i].value << endl; //Arbitrary weight
+        }
+    }
+    output.close();
+}
+
+
+/** \brief Read network data from plain MTX format
+*  \param filename: name of the file (including extension)
+*
+* The MTX format is defined by a simple plaintext representation of the adjancency matrix.
+* This function reads any MTX-like format
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::read_mtx(string filename) const
+{
+    //Destroy this object and create new network
+    clear_network(max_net_size);
+
+    bool read_header = false; //To see if we have read the dim1xdim2 links line
+    string line; //Store a line
+    ifstream input; //File
+    int from, to, w; //Auxiliary
+
+    //Open the file and checks avaiable
+    input.open(filename);
+    if (input.is_open())
+    {
+        while(getline(input, line)) //File we have not finished,
+        {
+            if (line[0] != '%') //If first char is not a comment
+            {
+                istringstream iss(line); //Transform into stream
+                if (read_header) //Have we read the header?
+                {
+                    //Then check if network is weighted
+                    if (typeid(B) == typeid(bool))
+                    {
+                        iss >> from >> to; //Fill vars with data from stream
+                        add_link(from, to);
+                    }
+                    else
+                    {
+                        iss >> from >> to >> w; //Fill vars with data from stream
+                        add_link(from, to, w);
+                    }
+
+                }
+                else
+                {
+                    read_header = true; //Then mark header as read
+                    iss >> from >> from >> to; //Matrix NxN so first two numbers are the same. "From" is N and "To" is the number of links
+                    add_nodes(from); //Add N nodes to the network
+                }
+
+            }
+
+        }
+    }
+    input.close();
+}
+
+
+/** \brief Largest eigenvalue calculator
+*  \param approx_error: desired margin of error for the eigenvalue
+*  \param max_it: optional. Limits the number of iterations. Default: 20
+*  \return vector that contains the largest eigenvalue (last element) and corresponding eigenvector.
+*
+* Computes the largest eigenvalue of the adjacency matrix using a power method. It returns a vector that
+* has the largest eigenvalue as the last element. The other values are the eigenvector.
+*/
+template <class T, typename B>
+vector<double> DirectedCNetwork<T,B>::compute_eigenv(double approx_error, int max_it) const
+{
+    return adjm.dom_eigen(approx_error, max_it);
+}
+
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Computes the PageRank of every node
+*  \param[out] rank: element j is the PageRank of node j. It sums 1.
+*  \param damping: optional. Probability of following a link instead of teleporting. Default: 0.85
+*  \param personalization: optional. Teleport probability of each node. If empty, teleport is uniform. A vector of wrong
+*  size or without a positive sum gives a warning, and teleport is uniform too.
+*  \param gauss_seidel: optional. If true, update ranks in place, which needs less iterations but runs sequentially.
+*  \param tolerance: optional. Stop when the L1 change of the ranks is below this value.
+*  \param max_it: optional. Maximum number of iterations.
+*  \return number of iterations done
+*
+* Power iteration where each node pulls the rank of the nodes pointing to it, so it runs in parallel without locks when
+* compiled with OpenMP. The rank of dangling nodes (without out-links) is redistributed following the personalization vector.
+* Links are unweighted. For undirected networks each link counts in both directions.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::pagerank(vector<double> &rank, double damping, const vector<double> &personalization, bool gauss_seidel, double tolerance, int max_it) const
+{
+    int i, it;
+    double dangling; //Rank accumulated in dangling nodes
+    double residual; //L1 difference between iterations
+    double norm;
+
+    const vector< vector<unsigned int> > &in_links = directed ? pointing_in : neighs;
+
+    vector<double> teleport(current_size, 1.0 / current_size);
+    vector<double> contribution(current_size); //Rank sent through each out-link
+    vector<double> next_rank;
+
+    if (current_size == 0) return 0;
+
+    //Normalize the personalization vector, if given. Unusable vectors fall back to uniform teleport
+    if ((int)personalization.size() == current_size)
+    {
+        norm = 0.0;
+        for (i=0; i < current_size; i++) norm += personalization[i];
+        if (norm > 0.0 and norm < numeric_limits<double>::infinity())
+        {
+            for (i=0; i < current_size; i++) teleport[i] = personalization[i] / norm;
+        }
+        else cout << "WARNING [DirectedCNetwork]: personalization vector does not have a positive sum. Using uniform teleport." << endl;
+    }
+    else if (personalization.size() > 0)
+    {
+        cout << "WARNING [DirectedCNetwork]: personalization vector has " << personalization.size() << " elements for "
+             << current_size << " nodes. Using uniform teleport." << endl;
+    }
+
+    rank = teleport;
+    next_rank = vector<double>(current_size);
+
+    it = 0;
+    residual = 1.0;
+    while (residual > tolerance and it < max_it)
+    {
+        dangling = 0.0;
+        #pragma omp parallel for reduction(+:dangling)
+        for (i=0; i < current_size; i++)
+        {
+            if (neighs[i].size() > 0) contribution[i] = rank[i] / neighs[i].size();
+            else
+            {
+                contribution[i] = 0.0;
+                dangling += rank[i];
+            }
+        }
+
+        residual = 0.0;
+        if (gauss_seidel)
+        {
+            //Update in place, so new ranks are used as soon as they are available
+            norm = 0.0;
+            for (i=0; i < current_size; i++)
+            {
+                double sum = 0.0;
+                for (int j=0; j < (int)in_links[i].size(); j++) sum += contribution[in_links[i][j]];
+                double r = (1.0 - damping) * teleport[i] + damping * (sum + dangling * teleport[i]);
+                residual += abs(r - rank[i]);
+                rank[i] = r;
+                if (neighs[i].size() > 0) contribution[i] = r / neighs[i].size();
+                norm += r;
+            }
+            for (i=0; i < current_size; i++) rank[i] /= norm;
+        }
+        else
+        {
+            #pragma omp parallel for schedule(dynamic, 1024) reduction(+:residual)
+            for (i=0; i < current_size; i++)
+            {
+                double sum = 0.0;
+                for (int j=0; j < (int)in_links[i].size(); j++) sum += contribution[in_links[i][j]];
+                next_rank[i] = (1.0 - damping) * teleport[i] + damping * (sum + dangling * teleport[i]);
+                residual += abs(next_rank[i] - rank[i]);
+            }
+            swap(rank, next_rank);
+        }
+
+        it += 1;
+    }
+
+    if (residual > tolerance) cout << "WARNING [DirectedCNetwork]: PageRank max number of iterations reached. Computation probably did NOT converge." << endl;
+
+    return it;
+}
+
+
+/** \brief Computes the Katz centrality of every node
+*  \param[out] centrality: element j is the Katz centrality of node j
+*  \param alpha: attenuation factor. It must be smaller than the inverse of the largest eigenvalue of the adjacency matrix.
+*  \param beta: optional. Centrality that each node gets for free. Default: 1
+*  \param tolerance: optional. Stop when the L1 change, relative to the L1 norm, is below this value.
+*  \param max_it: optional. Maximum number of iterations.
+*  \return number of iterations done
+*
+* Iterates x = alpha A^T x + beta, where each node pulls the centrality of the nodes pointing to it, in parallel.
+* The result is not normalized.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::katz_centrality(vector<double> &centrality, double alpha, double beta, double tolerance, int max_it) const
+{
+    int i, it;
+    double residual, norm;
+
+    const vector< vector<unsigned int> > &in_links = directed ? pointing_in : neighs;
+
+    vector<double> next(current_size);
+
+    centrality = vector<double>(current_size, beta);
+
+    it = 0;
+    residual = 1.0;
+    while (residual > tolerance and it < max_it)
+    {
+        residual = 0.0;
+        norm = 0.0;
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+:residual,norm)
+        for (i=0; i < current_size; i++)
+        {
+            double sum = 0.0;
+            for (int j=0; j < (int)in_links[i].size(); j++) sum += centrality[in_links[i][j]];
+            next[i] = alpha * sum + beta;
+            residual += abs(next[i] - centrality[i]);
+            norm += abs(next[i]);
+        }
+        swap(centrality, next);
+        residual = norm > 0.0 ? residual / norm : 0.0;
+
+        it += 1;
+    }
+
+    if (residual > tolerance) cout << "WARNING [DirectedCNetwork]: Katz max number of iterations reached. Check that alpha is small enough." << endl;
+
+    return it;
+}
+
+
+/** \brief Computes the eigenvector centrality of every node
+*  \param[out] centrality: element j is the eigenvector centrality of node j. Normalized to sum 1.
+*  \param tolerance: optional. Stop when the L1 change of the centrality is below this value.
+*  \param max_it: optional. Maximum number of iterations.
+*  \return number of iterations done
+*
+* Power iteration with the shifted matrix A^T + I, which has the same leading eigenvector but does not oscillate
+* in bipartite networks. Each node pulls from the nodes pointing to it, in parallel. Note that in directed networks
+* nodes outside strongly connected components with cycles get zero centrality; PageRank or Katz are better suited there.
+*/
+template <class T, typename B>
+int DirectedCNetwork<T,B>::eigenvector_centrality(vector<double> &centrality, double tolerance, int max_it) const
+{
+    int i, it;
+    double residual, norm;
+
+    const vector< vector<unsigned int> > &in_links = directed ? pointing_in : neighs;
+
+    vector<double> next(current_size);
+
+    if (current_size == 0) return 0;
+
+    centrality = vector<double>(current_size, 1.0 / current_size);
+
+    it = 0;
+    residual = 1.0;
+    while (residual > tolerance and it < max_it)
+    {
+        norm = 0.0;
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+:norm)
+        for (i=0; i < current_size; i++)
+        {
+            double sum = centrality[i]; //Shift by the identity
+            for (int j=0; j < (int)in_links[i].size(); j++) sum += centrality[in_links[i][j]];
+            next[i] = sum;
+            norm += sum;
+        }
+
+        residual = 0.0;
+        #pragma omp parallel for reduction(+:residual)
+        for (i=0; i < current_size; i++)
+        {
+            next[i] /= norm;
+            residual += abs(next[i] - centrality[i]);
+        }
+        swap(centrality, next);
+
+        it += 1;
+    }
+
+    if (residual > tolerance) cout << "WARNING [DirectedCNetwork]: eigenvector centrality max number of iterations reached. Computation probably did NOT converge." << endl;
+
+    return it;
+}
+
+
+
+/** \brief Approximate Personalized PageRank from a single seed
+*  \param seed: node where random walks restart
+*  \param[out] ppr: list of (node, score) pairs with non-zero score, sorted from highest to lowest score
+*  \param alpha: optional. Restart probability at each step. Default: 0.15
+*  \param epsilon: optional. Nodes are pushed while their residual per out-link is larger than epsilon.
+*  \param walks: optional. If positive, refine the push with approximately this number of random walks, as in FORA.
+*  \param random_seed: optional, default 123456789.
+*
+* Computes the PPR vector with the forward push of Andersen, Chung and Lang. The cost depends only on the part of the network
+* that is touched, not on its size, except for allocating the work vectors. To make many queries, use the version with a list
+* of seeds, which reuses memory. Dangling nodes restart the walk at the seed.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::personalized_pagerank(int seed, vector< pair<int,double> > &ppr, double alpha, double epsilon, int walks, unsigned int random_seed) const
+{
+    vector<double> estimate(current_size, 0.0), residual(current_size, 0.0);
+    vector<char> touched(current_size, 0);
+    vector<int> touched_list, queue;
+
+    ppr_push(seed, ppr, alpha, epsilon, walks, random_seed, estimate, residual, touched, touched_list, queue);
+    return;
+}
+
+
+/** \brief Approximate Personalized PageRank for many seeds
+*  \param seeds: list of seed nodes
+*  \param[out] ppr: element j is the list of (node, score) pairs for seeds[j], sorted from highest to lowest score
+*  \param alpha: optional. Restart probability at each step. Default: 0.15
+*  \param epsilon: optional. Nodes are pushed while their residual per out-link is larger than epsilon.
+*  \param walks: optional. If positive, refine each query with approximately this number of random walks.
+*  \param random_seed: optional, default 123456789.
+*
+* Runs a forward push for each seed. The work vectors are allocated once per thread and only the touched entries are
+* cleaned between queries, so the cost of each query does not depend on the size of the network. Seeds are processed
+* in parallel when compiled with OpenMP, and the results do not depend on the number of threads.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::personalized_pagerank(const vector<int> &seeds, vector< vector< pair<int,double> > > &ppr, double alpha, double epsilon, int walks, unsigned int random_seed) const
+{
+    int i;
+
+    ppr = vector< vector< pair<int,double> > >(seeds.size());
+
+    #pragma omp parallel
+    {
+        //Scratch memory shared by all the queries of this thread
+        vector<double> estimate(current_size, 0.0), residual(current_size, 0.0);
+        vector<char> touched(current_size, 0);
+        vector<int> touched_list, queue;
+
+        #pragma omp for schedule(dynamic, 1)
+        for (i=0; i < (int)seeds.size(); i++)
+        {
+            ppr_push(seeds[i], ppr[i], alpha, epsilon, walks, random_seed, estimate, residual, touched, touched_list, queue);
+        }
+    }
 
+    return;
+}
 
-/** \brief Read network data from plain MTX format
-*  \param filename: name of the file (including extension)
+
+/** \brief Forward push for Personalized PageRank, using given work vectors
+*  \param seed: node where random walks restart
+*  \param[out] ppr: list of (node, score) pairs with non-zero score, sorted from highest to lowest score
+*  \param alpha: restart probability at each step
+*  \param epsilon: threshold of residual per out-link
+*  \param walks: if positive, number of random walks for the refinement
+*  \param random_seed: seed for the random walks
+*  \param estimate: work vector of size current_size, all zeros. It is left clean.
+*  \param residual: work vector of size current_size, all zeros. It is left clean.
+*  \param touched: work vector of size current_size, all zeros. It is left clean.
+*  \param touched_list: work vector, storing the list of touched nodes.
+*  \param queue: work vector, used as queue of nodes to push.
 *
-* The MTX format is defined by a simple plaintext representation of the adjancency matrix.
-* This function reads any MTX-like format
-*/
-template <class T, typename B>
-void DirectedCNetwork<T,B>::read_mtx(string filename) const
-{
-    //Destroy this object and create new network
-    clear_network(max_net_size);
-
-    bool read_header = false; //To see if we have read the dim1xdim2 links line
-    string line; //Store a line
-    ifstream input; //File
-    int from, to, w; //Auxiliary
-
-    //Open the file and checks avaiable
-    input.open(filename);
-    if (input.is_open())
-    {
-        while(getline(input, line)) //File we have not finished,
-        {
-            if (line[0] != '%') //If first char is not a comment
-            {
-                istringstream iss(line); //Transform into stream
-                if (read_header) //Have we read the header?
-                {
-                    //Then check if network is weighted
-                    if (typeid(B) == typeid(bool))
-                    {
-                        iss >> from >> to; //Fill vars with data from stream
-                        add_link(from, to);
-                    }
-                    else
-                    {
-                        iss >> from >> to >> w; //Fill vars with data from stream
-                        add_link(from, to, w);
-                    }
-
-                }
-                else
-                {
-                    read_header = true; //Then mark header as read
-                    iss >> from >> from >> to; //Matrix NxN so first two numbers are the same. "From" is N and "To" is the number of links
-                    add_nodes(from); //Add N nodes to the network
-                }
-
-            }
-
-        }
-    }
-    input.close();
-}
+* Implementation of the push, with the optional Monte-Carlo refinement of FORA: the residual left at each node is
+* distributed by random walks started there, in proportion to its value.
+*/
+template <class T, typename B>
+void DirectedCNetwork<T,B>::ppr_push(int seed, vector< pair<int,double> > &ppr, double alpha, double epsilon, int walks, unsigned int random_seed,
+                                     vector<double> &estimate, vector<double> &residual, vector<char> &touched, vector<int> &touched_list, vector<int> &queue) const
+{
+    int i,j;
+    int u,v;
+    int r; //Read position in queue
+    int k;
+    double ru, share, residual_sum;
 
+    touched_list.clear();
+    queue.clear();
 
-/** \brief Largest eigenvalue calculator
-*  \param approx_error: desired margin of error for the eigenvalue
-*  \param max_it: optional. Limits the number of iterations. Default: 20
-*  \return vector that contains the largest eigenvalue (last element) and corresponding eigenvector.
+    residual[seed] = 1.0;
+    touched[seed] = 2; //1 means touched, 2 means touched and in queue
+    touched_list.push_back(seed);
+    queue.push_back(seed);
+
+    r = 0;
+    while (r < (int)queue.size())
+    {
+        u = queue[r];
+        r += 1;
+        touched[u] = 1;
+
+        k = neighs[u].size();
+        ru = residual[u];
+        if (ru <= epsilon * max(k, 1)) continue;
+
+        //Keep alpha of the residual, and spread the rest
+        estimate[u] += alpha * ru;
+        residual[u] = 0.0;
+        share = (1.0 - alpha) * ru / max(k, 1);
+
+        for (j=0; j < max(k, 1); j++)
+        {
+            v = k > 0 ? neighs[u][j] : seed; //Dangling nodes give everything back to the seed
+            residual[v] += share;
+            if (touched[v] == 0) touched_list.push_back(v);
+            if (touched[v] < 2 and residual[v] > epsilon * max((int)neighs[v].size(), 1))
+            {
+                touched[v] = 2;
+                queue.push_back(v);
+            }
+            else if (touched[v] == 0) touched[v] = 1;
+        }
+
+        //Reuse the memory of the queue once half of it has been read
+        if (r > 1024 and 2 * r > (int)queue.size())
+        {
+            queue.erase(queue.begin(), queue.begin() + r);
+            r = 0;
+        }
+    }
+
+    //Monte-Carlo refinement of the remaining residual
+    if (walks > 0)
+    {
+        rng_stream gen(random_seed, seed);
+
+        residual_sum = 0.0;
+        for (i=0; i < (int)touched_list.size(); i++) residual_sum += residual[touched_list[i]];
+
+        int n_touched = touched_list.size(); //Walks may touch new nodes, which have no residual
+        for (i=0; i < n_touched and residual_sum > 0.0; i++)
+        {
+            u = touched_list[i];
+            ru = residual[u];
+            if (ru <= 0.0) continue;
+
+            int n_walks = ceil(walks * ru / residual_sum);
+            for (j=0; j < n_walks; j++)
+            {
+                v = u;
+                while (gen.uniform() >= alpha)
+                {
+                    k = neighs[v].size();
+                    v = k > 0 ? neighs[v][gen.below(k)] : seed;
+                }
+                if (touched[v] == 0)
+                {
+                    touched[v] = 1;
+                    touched_list.push_back(v);
+                }
+                estimate[v] += ru / n_walks;
+            }
+        }
+    }
+
+    //Write results and clean the work vectors
+    ppr.clear();
+    for (i=0; i < (int)touched_list.size(); i++)
+    {
+        u = touched_list[i];
+        if (estimate[u] > 0.0) ppr.push_back(make_pair(u, estimate[u]));
+        estimate[u] = 0.0;
+        residual[u] = 0.0;
+        touched[u] = 0;
+    }
+    sort(ppr.begin(), ppr.end(), [](const pair<int,double> &a, const pair<int,double> &b) {return a.second > b.second;});
+
+    return;
+}
+
+
+// ========================================================================================================
+// ========================================================================================================
+// ========================================================================================================
+
+
+/** \brief Read-only filtered view of a network
 *
-* Computes the largest eigenvalue of the adjacency matrix using a power method. It returns a vector that
-* has the largest eigenvalue as the last element. The other values are the eigenvector.
-*/
-template <class T, typename B>
-vector<double> DirectedCNetwork<T,B>::compute_eigenv(double approx_error, int max_it) const
-{
-    return adjm.dom_eigen(approx_error, max_it);
+* Selects some nodes and links of a network without copying it. The view keeps a reference to the network, which must
+* not change while the view is used, a mask of the nodes kept and, optionally, a filter for links, called as
+* filter(from, to). Nodes keep their original indices. Links are kept if both ends are kept and they pass the filter.
+* Direction of links is ignored in the component methods, as in weak_components.
+*/
+template <class T, typename B>
+class NetworkView
+{
+    public:
+
+        NetworkView(const DirectedCNetwork<T,B> &network, const vector<bool> &node_mask = vector<bool>(), function<bool(int,int)> link_filter = nullptr);
+
+        bool has_node(int node_index) const;
+        bool has_link(int from, int to) const;
+        int get_node_count() const;
+        int get_link_count() const;
+
+        int out_degree(int node_index) const;
+        vector<unsigned int> get_neighs_out(int node_index) const;
+        double mean_degree() const;
+        void degree_distribution(vector<int> &distribution) const;
+
+        void breadth_first_search(int node, vector<int> &dist) const;
+        int weak_components(vector<int> &component) const;
+        int largest_component_size() const;
+
+    private:
+
+        const DirectedCNetwork<T,B> &net;
+        vector<bool> mask;
+        function<bool(int,int)> filter;
+};
+
+
+/** \brief Creates a view of a network
+*  \param network: network to look at
+*  \param node_mask: optional. Element j is true if node j is kept. If empty, all nodes are kept.
+*  \param link_filter: optional. Function called as link_filter(from, to), returning true if the link is kept.
+*/
+template <class T, typename B>
+NetworkView<T,B>::NetworkView(const DirectedCNetwork<T,B> &network, const vector<bool> &node_mask, function<bool(int,int)> link_filter) : net(network)
+{
+    mask = node_mask.size() > 0 ? node_mask : vector<bool>(network.current_size, true);
+    filter = link_filter;
+    return;
+}
+
+
+/** \brief Checks if a node is in the view
+*/
+template <class T, typename B>
+bool NetworkView<T,B>::has_node(int node_index) const
+{
+    return mask[node_index];
+}
+
+
+/** \brief Checks if a link from the network is in the view
+*  \param from, to: ends of an existing link
+*/
+template <class T, typename B>
+bool NetworkView<T,B>::has_link(int from, int to) const
+{
+    return mask[from] and mask[to] and (not filter or filter(from, to));
 }
 
 
+/** \brief Number of nodes in the view
+*/
+template <class T, typename B>
+int NetworkView<T,B>::get_node_count() const
+{
+    return count(mask.begin(), mask.end(), true);
+}
+
 
+/** \brief Number of links in the view
+*/
+template <class T, typename B>
+int NetworkView<T,B>::get_link_count() const
+{
+    int i, counter = 0;
+    for (i=0; i < net.link_count; i++) if (has_link(net.adjm.m[i].x, net.adjm.m[i].y)) counter++;
+    return counter;
+}
 
 
+/** \brief Number of links going out of a node in the view. For undirected networks, the degree.
+*/
+template <class T, typename B>
+int NetworkView<T,B>::out_degree(int node_index) const
+{
+    int i, counter = 0;
 
+    if (not mask[node_index]) return 0;
+    for (i=0; i < (int)net.neighs[node_index].size(); i++) if (has_link(node_index, net.neighs[node_index][i])) counter++;
+    return counter;
+}
 
 
-
+/** \brief Neighbours of a node in the view, following the direction of links
+*/
+template <class T, typename B>
+vector<unsigned int> NetworkView<T,B>::get_neighs_out(int node_index) const
+{
+    int i;
+    vector<unsigned int> result;
+
+    if (not mask[node_index]) return result;
+    for (i=0; i < (int)net.neighs[node_index].size(); i++) if (has_link(node_index, net.neighs[node_index][i])) result.push_back(net.neighs[node_index][i]);
+    return result;
+}
+
+
+/** \brief Mean out-degree of the nodes of the view
+*/
+template <class T, typename B>
+double NetworkView<T,B>::mean_degree() const
+{
+    int i, n = 0;
+    long long total = 0;
+
+    for (i=0; i < net.current_size; i++)
+    {
+        if (not mask[i]) continue;
+        total += out_degree(i);
+        n += 1;
+    }
+    return n > 0 ? 1.0 * total / n : 0.0;
+}
+
+
+/** \brief Out-degree distribution of the nodes of the view
+*  \param[out] distribution: element k is the number of nodes of the view with k links going out
+*/
+template <class T, typename B>
+void NetworkView<T,B>::degree_distribution(vector<int> &distribution) const
+{
+    int i, k;
+
+    distribution.clear();
+    for (i=0; i < net.current_size; i++)
+    {
+        if (not mask[i]) continue;
+        k = out_degree(i);
+        if (k >= (int)distribution.size()) distribution.resize(k+1, 0);
+        distribution[k] += 1;
+    }
+    return;
+}
+
+
+/** \brief Distances from a node inside the view, following the direction of links
+*  \param node: origin node
+*  \param[out] dist: distance to each node, or -1 if it cannot be reached inside the view
+*/
+template <class T, typename B>
+void NetworkView<T,B>::breadth_first_search(int node, vector<int> &dist) const
+{
+    int i, r, v, w;
+    vector<int> queue;
+
+    dist = vector<int>(net.current_size, -1);
+    if (not mask[node]) return;
+
+    dist[node] = 0;
+    queue.push_back(node);
+    r = 0;
+    while (r < (int)queue.size())
+    {
+        v = queue[r];
+        r += 1;
+        for (i=0; i < (int)net.neighs[v].size(); i++)
+        {
+            w = net.neighs[v][i];
+            if (dist[w] < 0 and has_link(v, w))
+            {
+                dist[w] = dist[v] + 1;
+                queue.push_back(w);
+            }
+        }
+    }
+    return;
+}
+
+
+/** \brief Connected components of the view, ignoring the direction of links
+*  \param[out] component: label of the component of each node, or -1 for nodes not in the view
+*  \return number of components
+*/
+template <class T, typename B>
+int NetworkView<T,B>::weak_components(vector<int> &component) const
+{
+    int i, j, r, v, w;
+    int n_comp = 0;
+    vector<int> queue;
+
+    component = vector<int>(net.current_size, -1);
+    for (i=0; i < net.current_size; i++)
+    {
+        if (not mask[i] or component[i] >= 0) continue;
+
+        component[i] = n_comp;
+        queue.clear();
+        queue.push_back(i);
+        r = 0;
+        while (r < (int)queue.size())
+        {
+            v = queue[r];
+            r += 1;
+            for (j=0; j < (int)net.neighs[v].size(); j++)
+            {
+                w = net.neighs[v][j];
+                if (component[w] < 0 and has_link(v, w))
+                {
+                    component[w] = n_comp;
+                    queue.push_back(w);
+                }
+            }
+            if (net.directed and v < (int)net.pointing_in.size())
+            {
+                for (j=0; j < (int)net.pointing_in[v].size(); j++)
+                {
+                    w = net.pointing_in[v][j];
+                    if (component[w] < 0 and has_link(w, v))
+                    {
+                        component[w] = n_comp;
+                        queue.push_back(w);
+                    }
+                }
+            }
+        }
+        n_comp += 1;
+    }
+
+    return n_comp;
+}
+
+
+/** \brief Size of the largest connected component of the view
+*/
+template <class T, typename B>
+int NetworkView<T,B>::largest_component_size() const
+{
+    int i, n_comp;
+    vector<int> component, size;
+
+    n_comp = weak_components(component);
+    size = vector<int>(n_comp, 0);
+    for (i=0; i < net.current_size; i++) if (component[i] >= 0) size[component[i]] += 1;
+
+    return n_comp > 0 ? *max_element(size.begin(), size.end()) : 0;
+}
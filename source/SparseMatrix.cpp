@@ -112,6 +112,7 @@ public:
     * Access to element index in the list.
     */
     data<T> &operator [](const int &index);
+    const data<T> &operator [](const int &index) const;
 
     /** \brief Power of a matrix
     * \param n: exponent
@@ -200,6 +201,7 @@ SparseMatrix<T> &SparseMatrix<T>::operator=(const SparseMatrix<T> &other)
     m_dim = other.m_dim;
     is_symmetric = other.is_symmetric;
     m = other.m;
+    return *this;
 }
 
 
@@ -465,6 +467,12 @@ data<T> &SparseMatrix<T>::operator [](const int &index)
     return m[index];
 }
 
+template<typename T>
+const data<T> &SparseMatrix<T>::operator [](const int &index) const
+{
+    return m[index];
+}
+
 template<typename T>
 SparseMatrix<double> SparseMatrix<T>::pow(const int n)
 {
@@ -504,7 +512,7 @@ vector<double> SparseMatrix<T>::dom_eigen(double epsilon, int max_it) const
 
     //Make the vector completely random to avoid being orthogonal to eigenvector
     i = 0;
-    while (i < m_dim)
+    while (i < (int)m_dim)
     {
         b[i] = ran_u(gen);
         i++;
@@ -525,7 +533,7 @@ vector<double> SparseMatrix<T>::dom_eigen(double epsilon, int max_it) const
         //Compute eigenvalue using Rayleigh's quotient.
         //Both scalar products are evaluated at the same time in order to be fast
         scp1 = scp2 = 0.0;
-        while (j < b.size())
+        while (j < (int)b.size())
         {
             scp1 += b[j] * bm[j];
             scp2 += b[j] * b[j];
@@ -558,7 +566,7 @@ void SparseMatrix<T>::normalize_vector(vector<double> &v) const
 
     //Compute sum of squares
     i = 0;
-    while(i < v.size())
+    while(i < (int)v.size())
     {
         sq += v[i]*v[i];
         i++;
@@ -567,7 +575,7 @@ void SparseMatrix<T>::normalize_vector(vector<double> &v) const
 
     //Then apply it
     i = 0;
-    while(i < v.size())
+    while(i < (int)v.size())
     {
         v[i] *= sq;
         i++;